@@ -75,9 +75,56 @@ public:
 };
 
 class image_block_t : public typed_index_t<image_block_t> {
+public:
   std::string description = {};
   using image_block_storage_t::image_block_storage_t;
+
+  /// @brief decoding occurs on the shared decode pool unless synchronous.
+  image_load_options_t load = image_load_options_t::asynchronous;
+
+  /// @brief painted over the image area until the decoded image is available.
+  painter_brush_t placeholder = {};
+
+  /// @brief draw from the nearest level of the image's mip chain when scaled
+  /// below its natural size.
+  bool mipmap = true;
+
+  /**
+   * @fn source_hash
+   * @brief the hash of the description for raster_key_t, computed on the
+   * first draw rather than on every draw. The library clears it when the
+   * unit is changed. A stale value only costs a miss, the raster cache
+   * compares the source on a hit. The hash is one atomic word, zero while
+   * not computed, so tiles that draw the unit at once may each compute it.
+   */
+  std::size_t source_hash(void) const {
+    std::size_t h = hash.value.load(std::memory_order_relaxed);
+    if (!h) {
+      h = std::hash<std::string>{}(description) | 1;
+      hash.value.store(h, std::memory_order_relaxed);
+    }
+    return h;
+  }
+
+  void clear_source_hash(void) {
+    hash.value.store(0, std::memory_order_relaxed);
+  }
+
   interface_guid_t alias = interface_alias::image_block_t;
+
+private:
+  /// @brief copies take the value, std::atomic itself is not copyable.
+  struct hash_cache_t {
+    hash_cache_t() {}
+    hash_cache_t(const hash_cache_t &other) : value(other.value.load()) {}
+    hash_cache_t &operator=(const hash_cache_t &other) {
+      value.store(other.value.load());
+      return *this;
+    }
+    std::atomic<std::size_t> value = {};
+  };
+
+  mutable hash_cache_t hash = {};
 };
 
 class mask_t : public typed_index_t<mask_t>, public painter_brush_t {
@@ -119,6 +166,38 @@ public:
   interface_guid_t alias = interface_alias::antialias_t;
 };
 
+class render_mode_t : public typed_index_t<render_mode_t> {
+public:
+  render_mode_options_t value = {};
+  interface_guid_t alias = interface_alias::render_mode_t;
+};
+
+class interaction_mode_t : public typed_index_t<interaction_mode_t> {
+public:
+  interaction_options_t value = interaction_options_t::automatic;
+  unsigned int idle_ms = INTERACTION_IDLE_MS;
+  interface_guid_t alias = interface_alias::interaction_mode_t;
+};
+
+/**
+ * @class z_order_t
+ * @brief the units input next by the same thread are ordered by value when
+ * several threads input to one surface, lower first. Units of equal z are
+ * ordered by when they were input.
+ */
+class z_order_t : public typed_index_t<z_order_t> {
+public:
+  std::int64_t value = {};
+  interface_guid_t alias = interface_alias::z_order_t;
+};
+
+class submission_policy_t : public typed_index_t<submission_policy_t> {
+public:
+  submission_policy_options_t value = submission_policy_options_t::block;
+  std::size_t capacity = SUBMISSION_QUEUE_CAPACITY;
+  interface_guid_t alias = interface_alias::submission_policy_t;
+};
+
 class graphic_operator_t : public typed_index_t<graphic_operator_t> {
   graphic_operator_options_t value = {};
   interface_guid_t alias = interface_alias::graphic_operator_t;
@@ -216,6 +295,20 @@ public:
   interface_guid_t alias = interface_alias::vline_t;
 };
 
+/**
+ * @class packed_path_t
+ * @brief a whole path submitted as one unit. The library reads the verb and
+ * coordinate arrays directly, there is no object per segment.
+ *   e.g. vis << packed_path_t{xs.data(), ys.data(), xs.size()}
+ *            << stroke_path_t{"black"};
+ */
+class packed_path_t : public typed_index_t<packed_path_t>,
+                      public packed_path_storage_t {
+public:
+  using packed_path_storage_t::packed_path_storage_t;
+  interface_guid_t alias = interface_alias::packed_path_t;
+};
+
 class rectangle_t : public typed_index_t<rectangle_t> {
 public:
   double x = {};
@@ -225,6 +318,29 @@ public:
   interface_guid_t alias = interface_alias::rectangle_t;
 };
 
+/**
+ * @class rectangle_list_t
+ * @brief many rectangles filled as one batch, optionally each with its own
+ * color.
+ */
+class rectangle_list_t : public typed_index_t<rectangle_list_t>,
+                         public rectangle_list_storage_t {
+public:
+  using rectangle_list_storage_t::rectangle_list_storage_t;
+  interface_guid_t alias = interface_alias::rectangle_list_t;
+};
+
+/**
+ * @class arc_list_t
+ * @brief many circles or pie segments filled as one batch.
+ */
+class arc_list_t : public typed_index_t<arc_list_t>,
+                   public arc_list_storage_t {
+public:
+  using arc_list_storage_t::arc_list_storage_t;
+  interface_guid_t alias = interface_alias::arc_list_t;
+};
+
 class surface_area_brush_t : public typed_index_t<surface_area_brush_t>,
                              public painter_brush_t {
 public:
@@ -244,7 +360,8 @@ public:
   interface_guid_t alias = interface_alias::text_alignment_t;
 };
 
-class text_color_t : public typed_index_t<text_color_t>, public painter_brush {
+class text_color_t : public typed_index_t<text_color_t>,
+                     public painter_brush_t {
 public:
   using painter_brush_t::painter_brush_t;
   interface_guid_t alias = interface_alias::text_color_t;
@@ -257,6 +374,21 @@ public:
   interface_guid_t alias = interface_alias::text_data_t;
 };
 
+/**
+ * @class text_file_t
+ * @brief text read from a file, or from length bytes at offset, through a
+ * memory mapping. A length of zero maps to the end of the file. With follow
+ * set, text appended to the file is shown as it is written.
+ */
+class text_file_t : public typed_index_t<text_file_t> {
+public:
+  std::string filename = {};
+  std::size_t offset = {};
+  std::size_t length = {};
+  bool follow = false;
+  interface_guid_t alias = interface_alias::text_file_t;
+};
+
 class text_ellipsize_t : public typed_index_t<text_ellipsize_t> {
 public:
   text_ellipsize_options_t value = {};
@@ -281,6 +413,12 @@ public:
   interface_guid_t alias = interface_alias::text_indent_t;
 };
 
+class text_layout_t : public typed_index_t<text_layout_t> {
+public:
+  text_layout_options_t value = text_layout_options_t::complete;
+  interface_guid_t alias = interface_alias::text_layout_t;
+};
+
 class text_line_space_t : public typed_index_t<text_line_space_t> {
 public:
   double value = {};
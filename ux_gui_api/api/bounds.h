@@ -0,0 +1,84 @@
+/*
+ * This file is part of the ux_gui_stream distribution
+ * (https://github.com/amatarazzo777/ux_gui_stream).
+ * Copyright (c) 2020 Anthony Matarazzo.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+/**
+@author Anthony Matarazzo
+@file bounds.h
+@date 10/28/20
+@version 1.0
+@details axis aligned rectangle in device units used by the damage, culling
+and tiling stages of rendering.
+*/
+
+namespace uxdevice {
+
+/**
+ * @internal
+ * @struct bounds_t
+ * @brief x, y is the top left. An empty bounds has a zero or negative width
+ * or height.
+ */
+struct bounds_t {
+  double x = {};
+  double y = {};
+  double w = {};
+  double h = {};
+
+  bool empty(void) const { return w <= 0 || h <= 0; }
+  double area(void) const { return empty() ? 0 : w * h; }
+  double right(void) const { return x + w; }
+  double bottom(void) const { return y + h; }
+
+  bool intersects(const bounds_t &o) const {
+    return !empty() && !o.empty() && x < o.right() && o.x < right() &&
+           y < o.bottom() && o.y < bottom();
+  }
+
+  bool contains(const bounds_t &o) const {
+    return !empty() && !o.empty() && o.x >= x && o.y >= y &&
+           o.right() <= right() && o.bottom() <= bottom();
+  }
+
+  /// @brief the smallest bounds covering both.
+  bounds_t unite(const bounds_t &o) const {
+    if (empty())
+      return o;
+    if (o.empty())
+      return *this;
+    double l = std::min(x, o.x), t = std::min(y, o.y);
+    return {l, t, std::max(right(), o.right()) - l,
+            std::max(bottom(), o.bottom()) - t};
+  }
+
+  bounds_t intersect(const bounds_t &o) const {
+    double l = std::max(x, o.x), t = std::max(y, o.y);
+    double r = std::min(right(), o.right()), b = std::min(bottom(), o.bottom());
+    if (r <= l || b <= t)
+      return {};
+    return {l, t, r - l, b - t};
+  }
+
+  /// @brief expands outward to whole pixels, as cairo clips are pixel aligned.
+  bounds_t pixel_aligned(void) const {
+    double l = std::floor(x), t = std::floor(y);
+    return {l, t, std::ceil(right()) - l, std::ceil(bottom()) - t};
+  }
+};
+
+} // namespace uxdevice
@@ -179,6 +179,15 @@ const uxdevice::client_interface_t::interface_guid_map_t
                              fn, std::placeholders::_1);
                        }},
 
+                      {interface_alias::fn_push_layer,
+                       [](client_interface_t &o, auto fn) {
+                         o.fn_push_layer =
+                             bind<void(content_type_t &,
+                                       layer_retain_options_t)>(
+                                 fn, std::placeholders::_1,
+                                 std::placeholders::_2);
+                       }},
+
                       {interface_alias::fn_pop,
                        [](client_interface_t &o, auto fn) {
                          o.fn_pop = bind<void(void)>(fn);
@@ -257,4 +266,20 @@ const uxdevice::client_interface_t::interface_guid_map_t
                       {interface_alias::fn_notify_complete,
                        [](client_interface_t &o, auto fn) {
                          o.fn_notify_complete = bind<void(void)>(fn);
+                       }},
+
+                      {interface_alias::fn_frame_statistics,
+                       [](client_interface_t &o, auto fn) {
+                         o.fn_frame_statistics =
+                             bind<void(frame_statistics_t &)>(
+                                 fn, std::placeholders::_1);
+                       }},
+
+                      {interface_alias::fn_notify_changed,
+                       [](client_interface_t &o, auto fn) {
+                         o.fn_notify_changed =
+                             bind<void(raw_std_string_t *,
+                                       const text_edit_t &)>(
+                                 fn, std::placeholders::_1,
+                                 std::placeholders::_2);
                        }}};
@@ -0,0 +1,89 @@
+/*
+ * This file is part of the ux_gui_stream distribution
+ * (https://github.com/amatarazzo777/ux_gui_stream).
+ * Copyright (c) 2020 Anthony Matarazzo.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+/**
+@author Anthony Matarazzo
+@file coalesce.h
+@date 11/5/20
+@version 1.0
+@details latest value wins. A keyed unit changed through
+surface_area_t::update<T>() is modified in place, so its current values are
+always the latest. The change notification only has to say that the unit
+changed, not how many times. Notifications are kept in a set drained once
+per frame, so a unit changed a thousand times in a frame is processed once,
+and the pending memory is bounded by the number of keyed units rather than
+the update rate.
+*/
+
+namespace uxdevice {
+
+/**
+ * @internal
+ * @class coalescing_set_t
+ * @tparam KEY identifies a unit, the unit address or its key.
+ * @brief mark() is called by the client thread after it writes the unit,
+ * take() by the render thread at the start of a frame. The lock orders the
+ * two, so every write made before a mark is visible once the key is taken.
+ * The lock is held only to insert a key or to swap the pending keys out.
+ */
+template <typename KEY> class coalescing_set_t {
+public:
+  /**
+   * @fn mark
+   * @brief records a change. Returns false when the key was already pending,
+   * in which case the change is counted as superseded.
+   */
+  bool mark(const KEY &k) {
+    std::lock_guard<std::mutex> guard(lock);
+    if (!index.insert(k).second) {
+      superseded++;
+      return false;
+    }
+    order.push_back(k);
+    return true;
+  }
+
+  /**
+   * @fn take
+   * @brief moves the pending keys, in the order first changed, to out and
+   * returns the number of changes superseded since the previous take.
+   */
+  std::size_t take(std::vector<KEY> &out) {
+    out.clear();
+    std::lock_guard<std::mutex> guard(lock);
+    out.swap(order);
+    index.clear();
+    std::size_t ret = superseded;
+    superseded = {};
+    return ret;
+  }
+
+  std::size_t pending(void) const {
+    std::lock_guard<std::mutex> guard(lock);
+    return order.size();
+  }
+
+private:
+  mutable std::mutex lock = {};
+  std::unordered_set<KEY> index = {};
+  std::vector<KEY> order = {};
+  std::size_t superseded = {};
+};
+
+} // namespace uxdevice
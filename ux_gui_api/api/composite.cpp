@@ -0,0 +1,525 @@
+/*
+ * This file is part of the ux_gui_stream distribution
+ * (https://github.com/amatarazzo777/ux_gui_stream).
+ * Copyright (c) 2020 Anthony Matarazzo.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @author Anthony Matarazzo
+ * @file composite.cpp
+ * @date 11/2/20
+ * @version 1.0
+ * @brief blend mode kernels. Values are held in signed 32 bit lanes, one
+ * channel per lane, so the products and sums of the scalar expression are
+ * computed exactly and every kernel produces identical bytes. Division by 255
+ * is (x + 128 + ((x + 128) >> 8)) >> 8. The hsl operators are not
+ * separable, the channels of a pixel are computed together in float, and
+ * every kernel uses the one float path.
+ */
+#include <base/std_base.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+#include "enums.h"
+#include "composite.h"
+
+namespace {
+
+enum class blend_t {
+  over,
+  add,
+  multiply,
+  screen,
+  overlay,
+  darken,
+  lighten,
+  hard_light,
+  difference,
+  exclusion,
+  hue,
+  saturation,
+  color,
+  luminosity
+};
+
+typedef void (*span_fn_t)(const std::uint32_t *, std::uint32_t *,
+                          std::size_t);
+
+int blend_index(uxdevice::graphic_operator_options_t op) {
+  using uxdevice::graphic_operator_options_t;
+  switch (op) {
+  case graphic_operator_options_t::op_over:
+    return static_cast<int>(blend_t::over);
+  case graphic_operator_options_t::op_add:
+    return static_cast<int>(blend_t::add);
+  case graphic_operator_options_t::op_multiply:
+    return static_cast<int>(blend_t::multiply);
+  case graphic_operator_options_t::op_screen:
+    return static_cast<int>(blend_t::screen);
+  case graphic_operator_options_t::op_overlay:
+    return static_cast<int>(blend_t::overlay);
+  case graphic_operator_options_t::op_darken:
+    return static_cast<int>(blend_t::darken);
+  case graphic_operator_options_t::op_lighten:
+    return static_cast<int>(blend_t::lighten);
+  case graphic_operator_options_t::op_hard_light:
+    return static_cast<int>(blend_t::hard_light);
+  case graphic_operator_options_t::op_difference:
+    return static_cast<int>(blend_t::difference);
+  case graphic_operator_options_t::op_exclusion:
+    return static_cast<int>(blend_t::exclusion);
+  case graphic_operator_options_t::op_hsl_hue:
+    return static_cast<int>(blend_t::hue);
+  case graphic_operator_options_t::op_hsl_saturation:
+    return static_cast<int>(blend_t::saturation);
+  case graphic_operator_options_t::op_hsl_color:
+    return static_cast<int>(blend_t::color);
+  case graphic_operator_options_t::op_hsl_luminosity:
+    return static_cast<int>(blend_t::luminosity);
+  default:
+    return -1;
+  }
+}
+
+inline std::int32_t div255(std::int32_t x) {
+  return (x + 128 + ((x + 128) >> 8)) >> 8;
+}
+
+/**
+ * @internal
+ * @brief the blend term B of the operator for one channel, scaled by
+ * 255 * 255. over is expressed as B = s * da so that it shares the
+ * expression.
+ */
+template <blend_t OP>
+inline std::int32_t blend_term(std::int32_t s, std::int32_t d,
+                               std::int32_t sa, std::int32_t da) {
+  if constexpr (OP == blend_t::over)
+    return s * da;
+  else if constexpr (OP == blend_t::multiply)
+    return s * d;
+  else if constexpr (OP == blend_t::screen)
+    return s * da + d * sa - s * d;
+  else if constexpr (OP == blend_t::overlay)
+    return 2 * d <= da ? 2 * s * d : sa * da - 2 * (da - d) * (sa - s);
+  else if constexpr (OP == blend_t::darken)
+    return std::min(s * da, d * sa);
+  else if constexpr (OP == blend_t::lighten)
+    return std::max(s * da, d * sa);
+  else if constexpr (OP == blend_t::hard_light)
+    return 2 * s <= sa ? 2 * s * d : sa * da - 2 * (da - d) * (sa - s);
+  else if constexpr (OP == blend_t::difference)
+    return s * da + d * sa - 2 * std::min(s * da, d * sa);
+  else
+    return s * da + d * sa - 2 * s * d;
+}
+
+template <blend_t OP>
+void span_scalar(const std::uint32_t *src, std::uint32_t *dst,
+                 std::size_t n) {
+  for (std::size_t i = 0; i < n; i++) {
+    std::uint32_t s = src[i], d = dst[i], out = {};
+
+    if constexpr (OP == blend_t::add) {
+      for (int shift = 0; shift < 32; shift += 8) {
+        std::uint32_t c = ((s >> shift) & 0xff) + ((d >> shift) & 0xff);
+        out |= std::min(c, 0xffu) << shift;
+      }
+    } else {
+      std::int32_t sa = s >> 24, da = d >> 24;
+      for (int shift = 0; shift < 24; shift += 8) {
+        std::int32_t sc = (s >> shift) & 0xff, dc = (d >> shift) & 0xff;
+        std::int32_t x = (255 - da) * sc + (255 - sa) * dc +
+                         blend_term<OP>(sc, dc, sa, da);
+        out |= static_cast<std::uint32_t>(
+                   std::min(div255(std::max(x, 0)), 255))
+               << shift;
+      }
+      out |= static_cast<std::uint32_t>(sa + da - div255(sa * da)) << 24;
+    }
+    dst[i] = out;
+  }
+}
+
+/**
+ * @internal
+ * @brief the color of a pixel for the hsl operators, premultiplied and
+ * scaled to 0 .. 1. The functions are those of the PDF blend modes, applied
+ * to premultiplied values as in pixman.
+ */
+struct rgb_t {
+  float c[3];
+};
+
+inline float lum(const rgb_t &v) {
+  return 0.3f * v.c[0] + 0.59f * v.c[1] + 0.11f * v.c[2];
+}
+
+inline float sat(const rgb_t &v) {
+  return std::max({v.c[0], v.c[1], v.c[2]}) -
+         std::min({v.c[0], v.c[1], v.c[2]});
+}
+
+inline rgb_t scaled(const rgb_t &v, float k) {
+  return {{v.c[0] * k, v.c[1] * k, v.c[2] * k}};
+}
+
+/// @brief v with luminosity l, clipped into 0 .. alpha keeping l.
+inline rgb_t set_lum(rgb_t v, float alpha, float l) {
+  float delta = l - lum(v);
+  for (auto &c : v.c)
+    c += delta;
+
+  l = lum(v);
+  float low = std::min({v.c[0], v.c[1], v.c[2]});
+  float high = std::max({v.c[0], v.c[1], v.c[2]});
+  if (low < 0)
+    for (auto &c : v.c)
+      c = l - low == 0 ? 0 : l + (c - l) * l / (l - low);
+  if (high > alpha)
+    for (auto &c : v.c)
+      c = high - l == 0 ? alpha : l + (c - l) * (alpha - l) / (high - l);
+  return v;
+}
+
+/// @brief v with saturation s, keeping the order of its channels.
+inline rgb_t set_sat(rgb_t v, float s) {
+  float *high = &v.c[0], *mid = &v.c[1], *low = &v.c[2];
+  if (*mid > *high)
+    std::swap(mid, high);
+  if (*low > *high)
+    std::swap(low, high);
+  if (*low > *mid)
+    std::swap(low, mid);
+
+  if (*high > *low) {
+    *mid = (*mid - *low) * s / (*high - *low);
+    *high = s;
+  } else {
+    *mid = *high = 0;
+  }
+  *low = 0;
+  return v;
+}
+
+template <blend_t OP>
+void span_hsl(const std::uint32_t *src, std::uint32_t *dst, std::size_t n) {
+  constexpr float k = 1.0f / 255;
+  for (std::size_t i = 0; i < n; i++) {
+    std::uint32_t s = src[i], d = dst[i];
+    std::int32_t sa8 = s >> 24, da8 = d >> 24;
+    float sa = sa8 * k, da = da8 * k;
+    rgb_t sc = {{(s >> 16 & 0xff) * k, (s >> 8 & 0xff) * k, (s & 0xff) * k}};
+    rgb_t dc = {{(d >> 16 & 0xff) * k, (d >> 8 & 0xff) * k, (d & 0xff) * k}};
+
+    rgb_t b = {};
+    if constexpr (OP == blend_t::hue)
+      b = set_lum(set_sat(scaled(sc, da), sat(dc) * sa), sa * da,
+                  lum(dc) * sa);
+    else if constexpr (OP == blend_t::saturation)
+      b = set_lum(set_sat(scaled(dc, sa), sat(sc) * da), sa * da,
+                  lum(dc) * sa);
+    else if constexpr (OP == blend_t::color)
+      b = set_lum(scaled(sc, da), sa * da, lum(dc) * sa);
+    else
+      b = set_lum(scaled(dc, sa), sa * da, lum(sc) * da);
+
+    std::uint32_t out = static_cast<std::uint32_t>(sa8 + da8 -
+                                                   div255(sa8 * da8))
+                        << 24;
+    for (int c = 0; c < 3; c++) {
+      float x = (1 - sa) * dc.c[c] + (1 - da) * sc.c[c] + b.c[c];
+      out |= static_cast<std::uint32_t>(
+                 std::clamp(std::lround(x * 255), 0L, 255L))
+             << (16 - 8 * c);
+    }
+    dst[i] = out;
+  }
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+
+/**
+ * @internal
+ * @brief one pixel per register, channels in lanes 0 to 3 with alpha in
+ * lane 3.
+ */
+__attribute__((target("sse4.1"))) inline __m128i mul_sse41(__m128i a,
+                                                            __m128i b) {
+  return _mm_mullo_epi32(a, b);
+}
+
+__attribute__((target("sse4.1"))) inline __m128i div255_sse41(__m128i x) {
+  x = _mm_add_epi32(x, _mm_set1_epi32(128));
+  return _mm_srli_epi32(_mm_add_epi32(x, _mm_srli_epi32(x, 8)), 8);
+}
+
+template <blend_t OP>
+__attribute__((target("sse4.1"))) inline __m128i blend_sse41(__m128i s,
+                                                              __m128i d) {
+  const __m128i c255 = _mm_set1_epi32(255);
+  __m128i sa = _mm_shuffle_epi32(s, _MM_SHUFFLE(3, 3, 3, 3));
+  __m128i da = _mm_shuffle_epi32(d, _MM_SHUFFLE(3, 3, 3, 3));
+
+  __m128i term = {};
+  if constexpr (OP == blend_t::over) {
+    term = mul_sse41(s, da);
+  } else if constexpr (OP == blend_t::multiply) {
+    term = mul_sse41(s, d);
+  } else if constexpr (OP == blend_t::screen) {
+    term = _mm_sub_epi32(_mm_add_epi32(mul_sse41(s, da), mul_sse41(d, sa)),
+                         mul_sse41(s, d));
+  } else if constexpr (OP == blend_t::overlay ||
+                       OP == blend_t::hard_light) {
+    __m128i twice = OP == blend_t::overlay ? _mm_add_epi32(d, d)
+                                           : _mm_add_epi32(s, s);
+    __m128i limit = OP == blend_t::overlay ? da : sa;
+    __m128i low = _mm_slli_epi32(mul_sse41(s, d), 1);
+    __m128i high = _mm_sub_epi32(
+        mul_sse41(sa, da),
+        _mm_slli_epi32(
+            mul_sse41(_mm_sub_epi32(da, d), _mm_sub_epi32(sa, s)), 1));
+    term = _mm_blendv_epi8(low, high, _mm_cmpgt_epi32(twice, limit));
+  } else if constexpr (OP == blend_t::darken) {
+    term = _mm_min_epi32(mul_sse41(s, da), mul_sse41(d, sa));
+  } else if constexpr (OP == blend_t::lighten) {
+    term = _mm_max_epi32(mul_sse41(s, da), mul_sse41(d, sa));
+  } else if constexpr (OP == blend_t::difference) {
+    __m128i a = mul_sse41(s, da), b = mul_sse41(d, sa);
+    term = _mm_sub_epi32(_mm_add_epi32(a, b),
+                         _mm_slli_epi32(_mm_min_epi32(a, b), 1));
+  } else {
+    term = _mm_sub_epi32(_mm_add_epi32(mul_sse41(s, da), mul_sse41(d, sa)),
+                         _mm_slli_epi32(mul_sse41(s, d), 1));
+  }
+
+  __m128i x = _mm_add_epi32(
+      _mm_add_epi32(mul_sse41(_mm_sub_epi32(c255, da), s),
+                    mul_sse41(_mm_sub_epi32(c255, sa), d)),
+      term);
+  __m128i c = div255_sse41(_mm_max_epi32(x, _mm_setzero_si128()));
+  __m128i a =
+      _mm_sub_epi32(_mm_add_epi32(sa, da), div255_sse41(mul_sse41(sa, da)));
+  return _mm_blend_epi16(c, a, 0xc0);
+}
+
+template <blend_t OP>
+__attribute__((target("sse4.1"))) void
+span_sse41(const std::uint32_t *src, std::uint32_t *dst, std::size_t n) {
+  std::size_t i = 0;
+  if constexpr (OP == blend_t::add) {
+    for (; i + 4 <= n; i += 4) {
+      __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+      __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i *>(dst + i));
+      _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i),
+                       _mm_adds_epu8(s, d));
+    }
+  } else {
+    for (; i + 4 <= n; i += 4) {
+      __m128i r[4];
+      for (int k = 0; k < 4; k++) {
+        __m128i s = _mm_cvtepu8_epi32(
+            _mm_cvtsi32_si128(static_cast<int>(src[i + k])));
+        __m128i d = _mm_cvtepu8_epi32(
+            _mm_cvtsi32_si128(static_cast<int>(dst[i + k])));
+        r[k] = blend_sse41<OP>(s, d);
+      }
+      __m128i p = _mm_packus_epi16(_mm_packus_epi32(r[0], r[1]),
+                                   _mm_packus_epi32(r[2], r[3]));
+      _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), p);
+    }
+  }
+  span_scalar<OP>(src + i, dst + i, n - i);
+}
+
+/**
+ * @internal
+ * @brief two pixels per register, one in each 128 bit half, so the alpha
+ * broadcast and blend work within halves as in the SSE4.1 kernel.
+ */
+__attribute__((target("avx2"))) inline __m256i mul_avx2(__m256i a,
+                                                         __m256i b) {
+  return _mm256_mullo_epi32(a, b);
+}
+
+__attribute__((target("avx2"))) inline __m256i div255_avx2(__m256i x) {
+  x = _mm256_add_epi32(x, _mm256_set1_epi32(128));
+  return _mm256_srli_epi32(_mm256_add_epi32(x, _mm256_srli_epi32(x, 8)), 8);
+}
+
+template <blend_t OP>
+__attribute__((target("avx2"))) inline __m256i blend_avx2(__m256i s,
+                                                           __m256i d) {
+  const __m256i c255 = _mm256_set1_epi32(255);
+  __m256i sa = _mm256_shuffle_epi32(s, _MM_SHUFFLE(3, 3, 3, 3));
+  __m256i da = _mm256_shuffle_epi32(d, _MM_SHUFFLE(3, 3, 3, 3));
+
+  __m256i term = {};
+  if constexpr (OP == blend_t::over) {
+    term = mul_avx2(s, da);
+  } else if constexpr (OP == blend_t::multiply) {
+    term = mul_avx2(s, d);
+  } else if constexpr (OP == blend_t::screen) {
+    term = _mm256_sub_epi32(_mm256_add_epi32(mul_avx2(s, da), mul_avx2(d, sa)),
+                            mul_avx2(s, d));
+  } else if constexpr (OP == blend_t::overlay ||
+                       OP == blend_t::hard_light) {
+    __m256i twice = OP == blend_t::overlay ? _mm256_add_epi32(d, d)
+                                           : _mm256_add_epi32(s, s);
+    __m256i limit = OP == blend_t::overlay ? da : sa;
+    __m256i low = _mm256_slli_epi32(mul_avx2(s, d), 1);
+    __m256i high = _mm256_sub_epi32(
+        mul_avx2(sa, da), _mm256_slli_epi32(mul_avx2(_mm256_sub_epi32(da, d),
+                                           _mm256_sub_epi32(sa, s)),
+                                       1));
+    term = _mm256_blendv_epi8(low, high, _mm256_cmpgt_epi32(twice, limit));
+  } else if constexpr (OP == blend_t::darken) {
+    term = _mm256_min_epi32(mul_avx2(s, da), mul_avx2(d, sa));
+  } else if constexpr (OP == blend_t::lighten) {
+    term = _mm256_max_epi32(mul_avx2(s, da), mul_avx2(d, sa));
+  } else if constexpr (OP == blend_t::difference) {
+    __m256i a = mul_avx2(s, da), b = mul_avx2(d, sa);
+    term = _mm256_sub_epi32(_mm256_add_epi32(a, b),
+                            _mm256_slli_epi32(_mm256_min_epi32(a, b), 1));
+  } else {
+    term = _mm256_sub_epi32(_mm256_add_epi32(mul_avx2(s, da), mul_avx2(d, sa)),
+                            _mm256_slli_epi32(mul_avx2(s, d), 1));
+  }
+
+  __m256i x = _mm256_add_epi32(
+      _mm256_add_epi32(mul_avx2(_mm256_sub_epi32(c255, da), s),
+                       mul_avx2(_mm256_sub_epi32(c255, sa), d)),
+      term);
+  __m256i c = div255_avx2(_mm256_max_epi32(x, _mm256_setzero_si256()));
+  __m256i a = _mm256_sub_epi32(_mm256_add_epi32(sa, da),
+                               div255_avx2(mul_avx2(sa, da)));
+  return _mm256_blend_epi32(c, a, 0x88);
+}
+
+template <blend_t OP>
+__attribute__((target("avx2"))) void
+span_avx2(const std::uint32_t *src, std::uint32_t *dst, std::size_t n) {
+  std::size_t i = 0;
+  if constexpr (OP == blend_t::add) {
+    for (; i + 8 <= n; i += 8) {
+      __m256i s =
+          _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + i));
+      __m256i d =
+          _mm256_loadu_si256(reinterpret_cast<const __m256i *>(dst + i));
+      _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i),
+                          _mm256_adds_epu8(s, d));
+    }
+  } else {
+    // the packs interleave the halves, p0 p2 p4 p6 in the low half and
+    // p1 p3 p5 p7 in the high half. The permute restores pixel order.
+    const __m256i order = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+    for (; i + 8 <= n; i += 8) {
+      __m256i r[4];
+      for (int k = 0; k < 4; k++) {
+        __m256i s = _mm256_cvtepu8_epi32(_mm_loadl_epi64(
+            reinterpret_cast<const __m128i *>(src + i + 2 * k)));
+        __m256i d = _mm256_cvtepu8_epi32(_mm_loadl_epi64(
+            reinterpret_cast<const __m128i *>(dst + i + 2 * k)));
+        r[k] = blend_avx2<OP>(s, d);
+      }
+      __m256i p = _mm256_packus_epi16(_mm256_packus_epi32(r[0], r[1]),
+                                      _mm256_packus_epi32(r[2], r[3]));
+      _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i),
+                          _mm256_permutevar8x32_epi32(p, order));
+    }
+  }
+  span_sse41<OP>(src + i, dst + i, n - i);
+}
+
+#endif
+
+#define UX_SPAN_TABLE(KERNEL)                                                  \
+  {                                                                            \
+    KERNEL<blend_t::over>, KERNEL<blend_t::add>, KERNEL<blend_t::multiply>,    \
+        KERNEL<blend_t::screen>, KERNEL<blend_t::overlay>,                     \
+        KERNEL<blend_t::darken>, KERNEL<blend_t::lighten>,                     \
+        KERNEL<blend_t::hard_light>, KERNEL<blend_t::difference>,              \
+        KERNEL<blend_t::exclusion>, span_hsl<blend_t::hue>,                    \
+        span_hsl<blend_t::saturation>, span_hsl<blend_t::color>,               \
+        span_hsl<blend_t::luminosity>                                          \
+  }
+
+const span_fn_t scalar_spans[] = UX_SPAN_TABLE(span_scalar);
+#if defined(__x86_64__) || defined(__i386__)
+const span_fn_t sse41_spans[] = UX_SPAN_TABLE(span_sse41);
+const span_fn_t avx2_spans[] = UX_SPAN_TABLE(span_avx2);
+#endif
+
+uxdevice::composite_kernel_t select_kernel(void) {
+#if defined(__x86_64__) || defined(__i386__)
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2"))
+    return uxdevice::composite_kernel_t::avx2;
+  if (__builtin_cpu_supports("sse4.1"))
+    return uxdevice::composite_kernel_t::sse41;
+#endif
+  return uxdevice::composite_kernel_t::scalar;
+}
+
+/// @brief a kernel the cpu does not support is clamped to the best one it
+/// does.
+const span_fn_t *spans(uxdevice::composite_kernel_t kernel) {
+  uxdevice::composite_kernel_t supported = uxdevice::composite_kernel();
+  if (kernel == uxdevice::composite_kernel_t::automatic || kernel > supported)
+    kernel = supported;
+#if defined(__x86_64__) || defined(__i386__)
+  if (kernel == uxdevice::composite_kernel_t::avx2)
+    return avx2_spans;
+  if (kernel == uxdevice::composite_kernel_t::sse41)
+    return sse41_spans;
+#endif
+  return scalar_spans;
+}
+
+} // namespace
+
+uxdevice::composite_kernel_t uxdevice::composite_kernel(void) {
+  static const composite_kernel_t kernel = select_kernel();
+  return kernel;
+}
+
+bool uxdevice::composite_supported(graphic_operator_options_t op) {
+  return blend_index(op) >= 0;
+}
+
+bool uxdevice::composite_span(graphic_operator_options_t op,
+                              const std::uint32_t *src, std::uint32_t *dst,
+                              std::size_t n, composite_kernel_t kernel) {
+  int index = blend_index(op);
+  if (index < 0)
+    return false;
+  spans(kernel)[index](src, dst, n);
+  return true;
+}
+
+bool uxdevice::composite_rectangle(graphic_operator_options_t op,
+                                   const std::uint32_t *src, int src_stride,
+                                   std::uint32_t *dst, int dst_stride, int w,
+                                   int h, composite_kernel_t kernel) {
+  int index = blend_index(op);
+  if (index < 0)
+    return false;
+  span_fn_t fn = spans(kernel)[index];
+  for (int y = 0; y < h; y++)
+    fn(src + static_cast<std::size_t>(y) * src_stride,
+       dst + static_cast<std::size_t>(y) * dst_stride, w);
+  return true;
+}
@@ -0,0 +1,83 @@
+/*
+ * This file is part of the ux_gui_stream distribution
+ * (https://github.com/amatarazzo777/ux_gui_stream).
+ * Copyright (c) 2020 Anthony Matarazzo.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+/**
+@author Anthony Matarazzo
+@file composite.h
+@date 11/2/20
+@version 1.0
+@details compositing of premultiplied ARGB32 spans for the separable
+graphic_operator_options_t blend modes and the hsl modes. Layers, masks
+and overlays drawn with these operators over large areas are composited here
+rather than by cairo. Each separable color channel is computed as one
+integer expression,
+
+  (ida * s + isa * d + B(s, d, sa, da)) / 255
+
+rounded once, where ida = 255 - da, isa = 255 - sa and B is the blend term
+of the operator scaled by 255 * 255. Alpha is sa + da - sa * da / 255. The
+AVX2 and SSE4.1 kernels evaluate the same expression in 32 bit lanes and
+produce the same bytes as the scalar kernel. The hsl modes are not
+separable and are computed per pixel in float, by every kernel alike.
+Color dodge, color burn and soft light remain with cairo.
+*/
+
+namespace uxdevice {
+
+/**
+ * @enum composite_kernel_t
+ * @brief the instruction set of a kernel. automatic is the best one the cpu
+ * supports.
+ */
+enum class composite_kernel_t { automatic, scalar, sse41, avx2 };
+
+/**
+ * @internal
+ * @fn composite_supported
+ * @brief true for op_over, op_add, op_multiply, op_screen, op_overlay,
+ * op_darken, op_lighten, op_hard_light, op_difference, op_exclusion and the
+ * four op_hsl operators.
+ */
+bool composite_supported(graphic_operator_options_t op);
+
+/**
+ * @internal
+ * @fn composite_span
+ * @brief dst[i] = src[i] op dst[i] for n pixels. Returns false, leaving dst
+ * unchanged, when the operator is not supported and cairo should be used.
+ * A kernel the cpu does not support runs as composite_kernel().
+ */
+bool composite_span(graphic_operator_options_t op, const std::uint32_t *src,
+                    std::uint32_t *dst, std::size_t n,
+                    composite_kernel_t kernel = composite_kernel_t::automatic);
+
+/**
+ * @internal
+ * @fn composite_rectangle
+ * @brief composite_span over w by h pixels. Strides are in pixels.
+ */
+bool composite_rectangle(
+    graphic_operator_options_t op, const std::uint32_t *src, int src_stride,
+    std::uint32_t *dst, int dst_stride, int w, int h,
+    composite_kernel_t kernel = composite_kernel_t::automatic);
+
+/// @brief the kernel selected for this cpu.
+composite_kernel_t composite_kernel(void);
+
+} // namespace uxdevice
@@ -0,0 +1,153 @@
+/*
+ * This file is part of the ux_gui_stream distribution
+ * (https://github.com/amatarazzo777/ux_gui_stream).
+ * Copyright (c) 2020 Anthony Matarazzo.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+/**
+@author Anthony Matarazzo
+@file culling.h
+@date 10/29/20
+@version 1.0
+@details viewport and occlusion culling of display units. Each drawing unit
+is given conservative device space bounds by applying the current matrix_t to
+its user space extent. Text units are bounded by the ink extent of their
+layout. Units outside the surface viewport are not visited. Units entirely
+beneath a later opaque rectangle fill are not visited either.
+*/
+
+namespace uxdevice {
+
+/**
+ * @internal
+ * @fn device_bounds
+ * @brief transforms the four corners of the user space rectangle and returns
+ * the device space rectangle that covers them. pad is added on every side
+ * before transforming, for the line width of strokes.
+ */
+inline bounds_t device_bounds(const matrix_t &m, const bounds_t &user,
+                              double pad = 0) {
+  const cairo_matrix_t &c = m._matrix;
+  double xs[2] = {user.x - pad, user.right() + pad};
+  double ys[2] = {user.y - pad, user.bottom() + pad};
+  double l = std::numeric_limits<double>::max(), t = l;
+  double r = std::numeric_limits<double>::lowest(), b = r;
+  for (double x : xs)
+    for (double y : ys) {
+      double dx = c.xx * x + c.xy * y + c.x0;
+      double dy = c.yx * x + c.yy * y + c.y0;
+      l = std::min(l, dx);
+      r = std::max(r, dx);
+      t = std::min(t, dy);
+      b = std::max(b, dy);
+    }
+  return {l, t, r - l, b - t};
+}
+
+/// @brief user space extent of a rectangle_t.
+inline bounds_t user_bounds(const uxapi::rectangle_t &o) {
+  double x = std::min(o.x, o.x + o.width), y = std::min(o.y, o.y + o.height);
+  return {x, y, std::abs(o.width), std::abs(o.height)};
+}
+
+/// @brief user space extent of an arc_t, the whole circle as the conservative
+/// bound.
+inline bounds_t user_bounds(const uxapi::arc_t &o) {
+  return {o.xc - o.radius, o.yc - o.radius, 2 * o.radius, 2 * o.radius};
+}
+
+/// @brief user space extent of a negative_arc_t.
+inline bounds_t user_bounds(const uxapi::negative_arc_t &o) {
+  return {o.xc - o.radius, o.yc - o.radius, 2 * o.radius, 2 * o.radius};
+}
+
+/**
+ * @internal
+ * @fn text_user_bounds
+ * @brief user space extent of text drawn at x, y. The text units carry no
+ * extent of their own, it is known only once the text is laid out, so ink
+ * is the ink rectangle of the layout relative to its origin, as reported by
+ * pango_layout_get_extents in user units. pad is added on every side for
+ * the line width of text_outline_t and the offset and blur of text_shadow_t.
+ */
+inline bounds_t text_user_bounds(double x, double y, const bounds_t &ink,
+                                 double pad = 0) {
+  return {x + ink.x - pad, y + ink.y - pad, ink.w + 2 * pad, ink.h + 2 * pad};
+}
+
+/**
+ * @internal
+ * @class occlusion_culler_t
+ * @brief visits the display list from last to first. A unit whose device
+ * bounds lie inside a rectangle filled later with an opaque result is
+ * occluded. Only axis aligned rectangle fills become occluders: op_source
+ * with any brush, or op_over with a solid brush of alpha 1. The occluder is
+ * shrunk to whole pixels so antialiased edges never hide a unit.
+ */
+class occlusion_culler_t {
+public:
+  occlusion_culler_t(std::size_t _limit = 16) : limit(_limit) {}
+
+  /// @brief true when the unit with these device bounds is hidden.
+  bool occluded(const bounds_t &b) const {
+    for (auto &o : occluders)
+      if (o.contains(b))
+        return true;
+    return false;
+  }
+
+  /**
+   * @fn add_fill
+   * @brief called for a rectangle_t followed by fill_path_t, in reverse
+   * display list order. The largest occluders are kept.
+   */
+  void add_fill(const matrix_t &m, const bounds_t &user,
+                const painter_brush_t &brush, graphic_operator_options_t op) {
+    const cairo_matrix_t &c = m._matrix;
+    if (c.xy != 0 || c.yx != 0)
+      return;
+
+    bool opaque = op == graphic_operator_options_t::op_source ||
+                  (op == graphic_operator_options_t::op_over &&
+                   brush.is_solid() && brush.color.a >= 1.0f);
+    if (!opaque)
+      return;
+
+    bounds_t d = device_bounds(m, user);
+    double l = std::ceil(d.x), t = std::ceil(d.y);
+    bounds_t inner = {l, t, std::floor(d.right()) - l,
+                      std::floor(d.bottom()) - t};
+    if (inner.empty())
+      return;
+
+    occluders.push_back(inner);
+    if (occluders.size() > limit) {
+      auto smallest = std::min_element(
+          occluders.begin(), occluders.end(),
+          [](auto &a, auto &b) { return a.area() < b.area(); });
+      occluders.erase(smallest);
+    }
+  }
+
+  /// @brief a clip or group boundary invalidates occluders found so far.
+  void reset(void) { occluders.clear(); }
+
+private:
+  std::size_t limit = {};
+  std::vector<bounds_t> occluders = {};
+};
+
+} // namespace uxdevice
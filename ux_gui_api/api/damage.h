@@ -0,0 +1,228 @@
+/*
+ * This file is part of the ux_gui_stream distribution
+ * (https://github.com/amatarazzo777/ux_gui_stream).
+ * Copyright (c) 2020 Anthony Matarazzo.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+/**
+@author Anthony Matarazzo
+@file damage.h
+@date 10/28/20
+@version 1.0
+@details partial redraw. When a keyed unit is changed through operator[] or
+get<T>(), the area it covered before the change and the area it covers after
+are both damaged. The damage of a frame is kept as a few rectangles. The render
+visit clips to them and skips every unit whose bounds do not intersect one.
+*/
+
+namespace uxdevice {
+
+/**
+ * @internal
+ * @class damage_region_t
+ * @brief a small set of rectangles covering all damaged areas. When another
+ * rectangle would exceed the limit, the pair whose union adds the least
+ * undamaged area is merged. Overlapping rectangles are always merged.
+ */
+class damage_region_t {
+public:
+  damage_region_t(std::size_t _limit = 8) : limit(_limit) {}
+
+  void add(bounds_t b) {
+    if (b.empty())
+      return;
+    b = b.pixel_aligned();
+
+    // absorb everything the new rectangle overlaps, repeating as the grown
+    // rectangle may now overlap others.
+    bool merged = true;
+    while (merged) {
+      merged = false;
+      for (auto it = rects.begin(); it != rects.end(); it++) {
+        if (it->intersects(b) || it->contains(b)) {
+          b = b.unite(*it);
+          rects.erase(it);
+          merged = true;
+          break;
+        }
+      }
+    }
+    rects.push_back(b);
+
+    while (rects.size() > limit)
+      merge_cheapest();
+  }
+
+  /// @brief true when the unit bounds must be rendered this frame.
+  bool intersects(const bounds_t &b) const {
+    for (auto &r : rects)
+      if (r.intersects(b))
+        return true;
+    return false;
+  }
+
+  /// @brief the damage limited to the surface, used when the surface resizes.
+  void clip(const bounds_t &surface) {
+    std::vector<bounds_t> clipped = {};
+    for (auto &r : rects) {
+      bounds_t c = r.intersect(surface);
+      if (!c.empty())
+        clipped.push_back(c);
+    }
+    rects = std::move(clipped);
+  }
+
+  double area(void) const {
+    double ret = {};
+    for (auto &r : rects)
+      ret += r.area();
+    return ret;
+  }
+
+  /// @brief moves the damage with framebuffer pixels that were scrolled.
+  void offset(double dx, double dy) {
+    for (auto &r : rects) {
+      r.x += dx;
+      r.y += dy;
+    }
+  }
+
+  bool empty(void) const { return rects.empty(); }
+  void clear(void) { rects.clear(); }
+  const std::vector<bounds_t> &rectangles(void) const { return rects; }
+
+private:
+  void merge_cheapest(void) {
+    std::size_t a = 0, b = 1;
+    double best = std::numeric_limits<double>::max();
+    for (std::size_t i = 0; i < rects.size(); i++)
+      for (std::size_t j = i + 1; j < rects.size(); j++) {
+        double cost = rects[i].unite(rects[j]).area() - rects[i].area() -
+                      rects[j].area();
+        if (cost < best) {
+          best = cost;
+          a = i;
+          b = j;
+        }
+      }
+    bounds_t u = rects[a].unite(rects[b]);
+    rects.erase(rects.begin() + static_cast<std::ptrdiff_t>(b));
+    rects.erase(rects.begin() + static_cast<std::ptrdiff_t>(a));
+    add(u);
+  }
+
+  std::size_t limit = {};
+  std::vector<bounds_t> rects = {};
+};
+
+/**
+ * @internal
+ * @class damage_tracker_t
+ * @brief the last rendered bounds of each unit, by the unit's identity within
+ * the display list. The damage of a frame must hold both the previous and the
+ * new bounds of every changed unit before the render visit filters units by
+ * it, otherwise the area a unit moved to is not repainted until a later
+ * frame. changed() adds the previous bounds. The new bounds are added by
+ * changed() when the caller knows them, or by measured() in a pass over the
+ * units() still pending that runs before the visit. A whole surface repaint,
+ * such as an expose or a resize, uses invalidate().
+ */
+class damage_tracker_t {
+public:
+  void changed(std::size_t id) {
+    auto it = last.find(id);
+    if (it != last.end())
+      region.add(it->second);
+    pending.insert(id);
+  }
+
+  /// @brief a change whose new bounds are known, no measuring is needed.
+  void changed(std::size_t id, const bounds_t &b) {
+    auto it = last.find(id);
+    if (it != last.end())
+      region.add(it->second);
+    region.add(b);
+    last[id] = b;
+    pending.erase(id);
+  }
+
+  /**
+   * @fn measured
+   * @brief the new bounds of a pending unit, measured before the visit.
+   */
+  void measured(std::size_t id, const bounds_t &b) {
+    region.add(b);
+    last[id] = b;
+    pending.erase(id);
+  }
+
+  /// @brief records the bounds a unit was rendered at. A unit whose bounds
+  /// differ from those recorded changed without notice, its area is
+  /// damaged for the next frame.
+  void rendered(std::size_t id, const bounds_t &b) {
+    auto it = last.find(id);
+    if (it == last.end() || b.x != it->second.x || b.y != it->second.y ||
+        b.w != it->second.w || b.h != it->second.h) {
+      if (it != last.end())
+        region.add(it->second);
+      region.add(b);
+    }
+    last[id] = b;
+  }
+
+  void removed(std::size_t id) {
+    auto it = last.find(id);
+    if (it != last.end()) {
+      region.add(it->second);
+      last.erase(it);
+    }
+    pending.erase(id);
+  }
+
+  void invalidate(const bounds_t &surface) {
+    region.clear();
+    region.add(surface);
+  }
+
+  /**
+   * @fn offset
+   * @brief the framebuffer was scrolled by dx, dy with scroll_pixels. The
+   * recorded bounds of every unit and the damage move with the pixels, so
+   * the next frame compares units against where they now are.
+   */
+  void offset(double dx, double dy) {
+    for (auto &n : last) {
+      n.second.x += dx;
+      n.second.y += dy;
+    }
+    region.offset(dx, dy);
+  }
+
+  /// @brief true while changed units wait for measured(), the damage is
+  /// not complete until then.
+  bool measuring(void) const { return !pending.empty(); }
+
+  /// @brief the changed units whose new bounds are not yet known.
+  const std::unordered_set<std::size_t> &units(void) const { return pending; }
+
+  damage_region_t region = {};
+
+private:
+  std::unordered_map<std::size_t, bounds_t> last = {};
+  std::unordered_set<std::size_t> pending = {};
+};
+
+} // namespace uxdevice
@@ -132,7 +132,7 @@ surface_area_t &uxdevice::surface_area_t::stream_input(const std::string &s) {
   /** @brief ship the resource to the library. The system will process this
    * matching the interface guid with logic on how to exactly decode it. This is
    * simply a pointer cast.*/
-  fn_input_resource(obj);
+  input_resource(obj);
 
   /// @brief free
   delete obj;
@@ -164,6 +164,7 @@ surface_area_t &uxdevice::surface_area_t::stream_input(
    * the mutex.
    */
   obj->interface(interface_guid_t::shared_resource_t);
+  obj->resource = _val.get();
 
   /** @brief the recipient (ux_gui_library) decodes this as any other
    * interface query. The size is also known about compared to the normal
@@ -174,10 +175,41 @@ surface_area_t &uxdevice::surface_area_t::stream_input(
 
   /** @brief ship the resource to the library. The system applies the
    * shared_resource_t behavior when dealing with this resource. */
-  fn_input_resource(obj);
+  input_resource(obj);
 
   /// @brief free
   delete obj;
 
   return *this;
 }
+
+/**
+ * @internal
+ * @fn notify_changed
+ * @param const std::shared_ptr<std::string> _val
+ * @param std::size_t offset
+ * @param std::size_t removed
+ * @param std::size_t inserted
+ * @brief sends the edit with the current data and size of the string. The
+ * library finds the text unit by the resource and relays out the paragraphs
+ * from the one at offset to the one at offset + removed.
+ */
+void uxdevice::surface_area_t::notify_changed(
+    const std::shared_ptr<std::string> _val, std::size_t offset,
+    std::size_t removed, std::size_t inserted) {
+  if (!fn_notify_changed)
+    return;
+
+  if (offset > _val->size() || inserted > _val->size() - offset) {
+    error_report(__FILE__, __LINE__, __func__,
+                 "notify_changed edit lies outside the string, ignored.");
+    return;
+  }
+
+  raw_std_string_t obj = {};
+  obj.ptr = _val->data();
+  obj.size = _val->size();
+  obj.resource = _val.get();
+
+  fn_notify_changed(&obj, text_edit_t{offset, removed, inserted});
+}
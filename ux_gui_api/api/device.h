@@ -86,6 +86,14 @@ private:                                                                       \
 /**
  * @class surface_area_t
  * @brief The main interface object of the system.
+ *
+ * Units may be input from several threads at once without a client lock.
+ * Each thread inputs into its own lane with its own transform stack, and
+ * the lanes are merged when a frame begins in z_order_t order and then in
+ * the order the units were input. Each unit carries the matrix and save
+ * levels of its thread, which are applied as the lanes are merged. Each
+ * thread ends its own frames with notify_complete(). Construction,
+ * assignment and destruction are not concurrent with input.
  */
 class surface_area_t : public system_error_t,
                        public library_interface_linkage_t {
@@ -156,10 +164,15 @@ public:
 
       apply_class_interfaces(obj);
 
+      /// @brief the library copy is not changed after input, its hash is
+      /// computed once here rather than on each cache lookup.
+      if constexpr (std::is_base_of<packed_path_storage_t, T>::value)
+        obj->finalize();
+
       /// @brief notice here that while it is a pointer, it is not considered a
       /// shared resource. The created_internally_not_shared_t is a signifier of
       /// this attribute.
-      fn_input_resource(obj.get());
+      input_resource(obj.get());
 
       delete obj;
 
@@ -220,7 +233,27 @@ public:
   template <typename T>
   surface_area_t &operator<<(const std::shared_ptr<T> obj) {
     obj->interface(interface_guid_t::shared_resource_t);
-    fn_input_resource(obj.get());
+
+    /// @brief a client that later writes the arrays of a shared path calls
+    /// finalize() again under its mutex.
+    if constexpr (std::is_base_of<packed_path_storage_t, T>::value)
+      obj->finalize();
+
+    input_resource(obj.get());
+
+    return *this;
+  }
+
+  /**
+   * @fn operator<<
+   * @brief a versioned resource is read by the library without a mutex. The
+   * client publishes new versions rather than writing the data in place.
+   */
+  template <typename T>
+  surface_area_t &
+  operator<<(const std::shared_ptr<versioned_resource_t<T>> obj) {
+    obj->interface(interface_guid_t::versioned_resource_t);
+    input_resource(obj.get());
 
     return *this;
   }
@@ -299,7 +332,8 @@ public:
 
   /**
    * @fn T get&(const std::string&)
-   * @brief
+   * @brief the keyed unit, for reading. A change made through the reference
+   * is not reported, use update<T>().
    *
    * @tparam T
    * @param key
@@ -307,24 +341,137 @@ public:
    */
   template <typename T> T &get(const std::string &key) {
     auto n = fn_linked_mapped_objects_find_string(key.data(), key.size());
+    return *std::dynamic_cast<T>(n->second);
+  }
 
-    if (n != mapped_objects.end())
-      n->second->changed();
+  /**
+   * @fn update
+   * @brief changes the keyed unit in place by calling fn with it, then marks
+   * it changed. The mark follows the write, so the render thread that takes
+   * the mark sees the new values. Changes are coalesced: however often a
+   * unit is updated between frames it is processed once, with the values it
+   * has when the frame begins. The updates that did not need processing are
+   * counted in frame_statistics_t::updates_superseded.
+   *
+   * @tparam T
+   * @param key
+   * @param fn called as fn(T &).
+   * @return false when no unit has the key.
+   */
+  template <typename T, typename FN>
+  bool update(const std::string &key, FN &&fn) {
+    auto n = fn_linked_mapped_objects_find_string(key.data(), key.size());
+    if (n == mapped_objects.end())
+      return false;
+
+    T *ptr = std::dynamic_cast<T>(n->second);
+    fn(*ptr);
+    ptr->changed();
+    updates.mark(ptr);
+    return true;
+  }
 
-    return *std::dynamic_cast<T>(n->second);
+  /**
+   * @fn take_updates
+   * @brief called by the render thread at the start of a frame. Moves the
+   * units updated since the previous frame to out, in the order first
+   * updated, and returns the number of updates superseded.
+   */
+  std::size_t take_updates(std::vector<client_data_interface_base_t *> &out) {
+    return updates.take(out);
   }
 
   std::string &operator[](std::shared_ptr<std::string> _val) noexcept;
 
+  /**
+   * @fn notify_changed
+   * @brief reports an edit made in place to a shared string that was input
+   * earlier: removed bytes at offset were replaced by inserted bytes. Only
+   * the paragraphs the edit touches are shaped and laid out again, the rest
+   * keep their layouts and move. The edit is made while holding the mutex of
+   * the shared resource and reported after it is released.
+   */
+  void notify_changed(const std::shared_ptr<std::string> _val,
+                      std::size_t offset, std::size_t removed,
+                      std::size_t inserted);
+
   bool processing(void) { return bProcessing; };
 
+  /**
+   * @fn statistics
+   * @brief measurements of the most recently completed frame, such as the
+   * damaged area repainted and the number of units rendered.
+   */
+  frame_statistics_t statistics(void) {
+    frame_statistics_t ret = {};
+    if (fn_frame_statistics)
+      fn_frame_statistics(ret);
+    return ret;
+  }
+
+  /**
+   * @fn notify_complete
+   * @brief ends the calling thread's input of a frame, and resets its
+   * transform stack so its next frame begins from the identity matrix with
+   * no save open. The stacks of other threads are left as they are, since
+   * they may be between a save and its restore; each thread that inputs
+   * ends its own frames.
+   */
+  void notify_complete(void) {
+    if (fn_notify_complete)
+      fn_notify_complete();
+    stack().reset();
+  }
+
+  /**
+   * @fn save
+   * @brief the transform and save stack is kept by the client, one per
+   * thread. These calls do not cross to the library. The net matrix and the
+   * open save levels are sent with each unit that is input.
+   */
+  void save(void) { stack().save(); }
+  void restore(void) { stack().restore(); }
+
+  void translate(double tx, double ty) { stack().translate(tx, ty); }
+  void scale(double sx, double sy) { stack().scale(sx, sy); }
+  void rotate(double radians) { stack().rotate(radians); }
+  void transform(const matrix_t &m) { stack().transform(m); }
+  void matrix(const matrix_t &m) { stack().set(m); }
+  void identity(void) { stack().identity(); }
+
+  /// @brief the composed matrix, for hit testing and layout in client code.
+  const matrix_t &matrix(void) const { return stack().matrix(); }
+
+  /// @brief moves the device origin, which applies under the matrix of
+  /// every unit.
+  void device_offset(double x, double y) {
+    if (fn_device_offset)
+      fn_device_offset(x, y);
+  }
+
 private:
   void set_surface_defaults(void);
 
+  /**
+   * @fn input_resource
+   * @brief ships a unit to the library. A unit rejected by the fail_fast
+   * submission policy is reported as an error, the stream continues.
+   */
+  void input_resource(client_data_interface_base_t *obj) {
+    if (fn_input_resource(obj, stack().state()) == submit_result_t::rejected)
+      error_report(__FILE__, __LINE__, __func__,
+                   "submission queue full, unit rejected.");
+  }
+
+  /// @brief the calling thread's transform stack.
+  transform_stack_t &stack(void) const { return transforms.local(); }
+
 private:
   std::shared_ptr<linked_window_manager_t> window_manager = {};
   std::shared_ptr<display_context_t> context = {};
   std::atomic<bool> bProcessing = false;
+  per_thread_t<transform_stack_t> transforms = {};
+  coalescing_set_t<client_data_interface_base_t *> updates = {};
 
   event_handler_t fnEvents = nullptr;
 
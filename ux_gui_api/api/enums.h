@@ -148,6 +148,61 @@ enum class text_ellipsize_options_t {
   end = PANGO_ELLIPSIZE_END
 };
 
+/**
+ * @enum image_load_options_t
+ * @brief how an image_block_t is decoded. asynchronous draws the placeholder
+ * until the decode pool completes. progressive also draws the partial images
+ * the decoder reports. synchronous decodes before the unit is processed.
+ */
+enum class image_load_options_t { asynchronous, progressive, synchronous };
+
+/**
+ * @enum layer_retain_options_t
+ * @brief off renders the group every frame. retained keeps the rendered group
+ * as an offscreen surface that is reused until a unit within it changes.
+ */
+enum class layer_retain_options_t { off, retained };
+
+/**
+ * @enum render_mode_options_t
+ * @brief single_thread renders the surface on its rendering thread. tiled
+ * splits the surface into tiles rendered on RENDER_THREADS threads. The
+ * output of both is identical, tiles are padded for units such as shadow
+ * blurs that read across a tile edge. See tile_render.h.
+ */
+enum class render_mode_options_t { single_thread, tiled };
+
+/**
+ * @enum interaction_options_t
+ * @brief automatic renders at reduced quality while a drag, scroll or resize
+ * is in progress and at full quality once input is idle. off always renders
+ * at full quality.
+ */
+enum class interaction_options_t { automatic, off };
+
+/**
+ * @enum text_layout_options_t
+ * @brief complete lays out the whole text. virtualized lays out only the
+ * lines near the viewport, for very large documents of unwrapped lines of
+ * uniform height.
+ */
+enum class text_layout_options_t { complete, virtualized };
+
+/**
+ * @enum submission_policy_options_t
+ * @brief what input does when the queue of units waiting for the renderer is
+ * full. block waits for the renderer, drop_oldest discards the oldest
+ * queued drawing unit, keeping units that set state, and fail_fast rejects
+ * the unit with an error.
+ */
+enum class submission_policy_options_t { block, drop_oldest, fail_fast };
+
+/**
+ * @enum submit_result_t
+ * @brief the outcome of fn_input_resource for a unit.
+ */
+enum class submit_result_t { queued, dropped_oldest, rejected };
+
 /**
  * @enum content_options_t
  * @grief
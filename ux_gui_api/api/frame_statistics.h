@@ -0,0 +1,103 @@
+/*
+ * This file is part of the ux_gui_stream distribution
+ * (https://github.com/amatarazzo777/ux_gui_stream).
+ * Copyright (c) 2020 Anthony Matarazzo.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+/**
+@author Anthony Matarazzo
+@file frame_statistics.h
+@date 10/28/20
+@version 1.0
+@details per frame measurements reported by the library. The structure is
+raw data only as it is filled across the library boundary.
+*/
+
+namespace uxdevice {
+
+/**
+ * @struct frame_statistics_t
+ * @brief the values describe the most recently completed frame of a surface.
+ */
+struct frame_statistics_t {
+  interface_guid_t alias = interface_alias::frame_statistics_t;
+
+  std::uint64_t frame = {};
+  double frame_time_ms = {};
+
+  /// @brief the area of the surface and the area repainted, in pixels.
+  double surface_area = {};
+  double damage_area = {};
+  std::uint32_t damage_rectangles = {};
+
+  /// @brief display units in the display list and those visited to render.
+  std::uint64_t units_total = {};
+  std::uint64_t units_rendered = {};
+
+  /// @brief units not visited because their device bounds were outside the
+  /// viewport, or inside a later opaque rectangle fill.
+  std::uint64_t units_culled_viewport = {};
+  std::uint64_t units_culled_occluded = {};
+
+  /// @brief true when the frame was produced by moving the previous pixels,
+  /// with the delta in device pixels.
+  std::uint32_t scroll_blit = {};
+  std::int32_t scroll_dx = {};
+  std::int32_t scroll_dy = {};
+
+  /// @brief retained layers composited instead of rendered, and the memory
+  /// held by retained layers.
+  std::uint64_t layers_composited = {};
+  std::uint64_t layers_rendered = {};
+  std::uint64_t layer_bytes = {};
+
+  /// @brief strokes drawn from the stroke cache and strokes computed.
+  std::uint64_t strokes_cached = {};
+  std::uint64_t strokes_computed = {};
+
+  /// @brief for render_mode_options_t::tiled, the tiles rendered, those with
+  /// at least one drawing unit, and the threads that rendered them.
+  std::uint32_t tiles_rendered = {};
+  std::uint32_t render_threads = {};
+
+  /// @brief true when the frame was rendered at reduced quality during an
+  /// interaction.
+  std::uint32_t interactive = {};
+
+  /// @brief true when the frame stretched the previous frame during a live
+  /// resize, and the text layouts reused and built for the frame.
+  std::uint32_t resize_stretched = {};
+  std::uint64_t layouts_cached = {};
+  std::uint64_t layouts_built = {};
+
+  /// @brief keyed units processed because they changed, and the further
+  /// changes to them in the same frame that were coalesced.
+  std::uint64_t updates_applied = {};
+  std::uint64_t updates_superseded = {};
+
+  /// @brief the submission queue: units waiting when the frame began, the
+  /// most waiting at once, producers blocked by a full queue and for how
+  /// long, and units dropped or rejected by the submission policy.
+  std::uint64_t queue_depth = {};
+  std::uint64_t queue_depth_max = {};
+  std::uint64_t submit_waits = {};
+  double submit_wait_ms = {};
+  double submit_wait_max_ms = {};
+  std::uint64_t submits_dropped = {};
+  std::uint64_t submits_rejected = {};
+};
+
+} // namespace uxdevice
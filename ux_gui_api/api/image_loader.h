@@ -0,0 +1,218 @@
+/*
+ * This file is part of the ux_gui_stream distribution
+ * (https://github.com/amatarazzo777/ux_gui_stream).
+ * Copyright (c) 2020 Anthony Matarazzo.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+/**
+@author Anthony Matarazzo
+@file image_loader.h
+@date 10/26/20
+@version 1.0
+@details The background decode pipeline for image_block_t. The unit's
+description is resolved and decoded on the decode thread pool so a large PNG or
+SVG does not stall the thread that processes the display units. Until the
+decode is complete, the render visit draws the placeholder brush of the unit,
+or the most recent partial image when the decoder reports progress.
+*/
+
+namespace uxdevice {
+
+/**
+ * @internal
+ * @class image_loader_t
+ * @tparam IMAGE the decoded image the library draws, typically a wrapper
+ * around cairo_surface_t.
+ * @brief one instance is shared by all surfaces of the process. Decoded images
+ * are held in a byte budgeted lru_cache_t. Concurrent requests for the same
+ * description are joined onto one decode. A description that failed to decode
+ * is remembered and not decoded again until retry() is called for it.
+ */
+template <typename IMAGE> class image_loader_t {
+public:
+  typedef std::shared_ptr<IMAGE> image_t;
+
+  /// @brief receives partial images while decoding, for progressive display.
+  typedef std::function<void(image_t)> progress_fn_t;
+
+  /**
+   * @brief decodes the bytes of a source. The return is the image and the
+   * number of bytes it occupies, which is charged against the cache budget.
+   */
+  typedef std::function<std::pair<image_t, std::size_t>(
+      const char *, std::size_t, const progress_fn_t &)>
+      decode_fn_t;
+
+  /// @brief called on the decode thread when an image becomes available.
+  typedef std::function<void(const std::string &)> ready_fn_t;
+
+  /// @brief zero threads, as IMAGE_DECODE_THREADS defaults to, is one per
+  /// hardware thread.
+  image_loader_t(decode_fn_t _decode, std::size_t _threads,
+                 std::size_t _budget)
+      : decode(_decode), cache(_budget), pool(_threads) {}
+
+  /**
+   * @fn request
+   * @brief returns the decoded image when it is cached. Otherwise a decode is
+   * queued, if one is not already pending, and nullptr is returned, or for
+   * image_load_options_t::progressive the latest partial image. The ready
+   * callback is invoked after the decode completes so the caller can mark
+   * the unit changed, and for progressive also with each partial image.
+   * synchronous waits for the decode, as wait() does.
+   */
+  image_t
+  request(const std::string &description, const ready_fn_t &ready,
+          image_load_options_t mode = image_load_options_t::asynchronous) {
+    if (mode == image_load_options_t::synchronous)
+      return wait(description);
+
+    if (auto img = cache.find(description))
+      return img;
+
+    bool progressive = mode == image_load_options_t::progressive;
+    std::lock_guard<std::mutex> guard(lock);
+    if (failed.count(description))
+      return {};
+
+    auto it = pending.find(description);
+    if (it != pending.end()) {
+      it->second.waiting.push_back({ready, progressive});
+      return progressive ? it->second.partial : image_t{};
+    }
+
+    pending[description].waiting.push_back({ready, progressive});
+    pool.submit([this, description]() { run(description); });
+    return {};
+  }
+
+  /**
+   * @fn wait
+   * @brief synchronous form used when the unit is submitted with
+   * image_load_options_t::synchronous.
+   */
+  image_t wait(const std::string &description) {
+    if (auto img = cache.find(description))
+      return img;
+
+    request(description, [](const std::string &) {},
+            image_load_options_t::asynchronous);
+
+    std::unique_lock<std::mutex> guard(lock);
+    completed.wait(guard, [&]() {
+      return pending.find(description) == pending.end();
+    });
+    guard.unlock();
+
+    return cache.find(description);
+  }
+
+  /// @brief true when the last decode of the description failed.
+  bool failed_decode(const std::string &description) {
+    std::lock_guard<std::mutex> guard(lock);
+    return failed.count(description) != 0;
+  }
+
+  /// @brief forgets a failure, for example after the file was replaced, so
+  /// the next request decodes it again.
+  void retry(const std::string &description) {
+    std::lock_guard<std::mutex> guard(lock);
+    failed.erase(description);
+  }
+
+  lru_cache_t<std::string, IMAGE> &images(void) { return cache; }
+
+private:
+  struct waiter_t {
+    ready_fn_t ready = {};
+    bool progressive = false;
+  };
+
+  struct pending_t {
+    image_t partial = {};
+    std::vector<waiter_t> waiting = {};
+  };
+
+  /**
+   * @internal
+   * @brief the description is either a file name, read through a mapping, or
+   * inline image data such as an svg document.
+   */
+  void run(const std::string &description) {
+    std::pair<image_t, std::size_t> result = {};
+
+    auto fn_progress = [&](image_t partial) {
+      std::vector<ready_fn_t> notify = {};
+      {
+        std::lock_guard<std::mutex> guard(lock);
+        auto it = pending.find(description);
+        if (it == pending.end())
+          return;
+        it->second.partial = partial;
+        for (auto &w : it->second.waiting)
+          if (w.progressive)
+            notify.push_back(w.ready);
+      }
+      for (auto &fn : notify)
+        fn(description);
+    };
+
+    try {
+      struct stat st = {};
+      if (description.size() < PATH_MAX &&
+          stat(description.data(), &st) == 0 && S_ISREG(st.st_mode)) {
+        mapped_file_t file(description);
+        result = decode(file.data(), file.size(), fn_progress);
+      } else {
+        result = decode(description.data(), description.size(), fn_progress);
+      }
+    } catch (...) {
+      result = {};
+    }
+
+    if (result.first)
+      cache.insert(description, result.first, result.second);
+
+    std::vector<ready_fn_t> notify = {};
+    {
+      std::lock_guard<std::mutex> guard(lock);
+      if (!result.first)
+        failed.insert(description);
+      auto it = pending.find(description);
+      if (it != pending.end()) {
+        for (auto &w : it->second.waiting)
+          notify.push_back(std::move(w.ready));
+        pending.erase(it);
+      }
+    }
+    completed.notify_all();
+    for (auto &fn : notify)
+      fn(description);
+  }
+
+  decode_fn_t decode = {};
+  lru_cache_t<std::string, IMAGE> cache;
+  std::mutex lock = {};
+  std::condition_variable completed = {};
+  std::unordered_map<std::string, pending_t> pending = {};
+  std::unordered_set<std::string> failed = {};
+
+  // declared last so the workers are joined before the members they use are
+  // destroyed.
+  thread_pool_t pool;
+};
+
+} // namespace uxdevice
@@ -0,0 +1,209 @@
+/*
+ * This file is part of the ux_gui_stream distribution
+ * (https://github.com/amatarazzo777/ux_gui_stream).
+ * Copyright (c) 2020 Anthony Matarazzo.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @author Anthony Matarazzo
+ * @file image_mipmap.cpp
+ * @date 10/27/20
+ * @version 1.0
+ * @brief mip chain generation. The 2x2 box kernels are written for scalar,
+ * SSE2 and AVX2. Each channel is computed as (a + b + c + d + 2) >> 2 in 16
+ * bit lanes so every kernel produces identical bytes.
+ */
+#include <base/std_base.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+#include "image_mipmap.h"
+
+namespace {
+
+typedef void (*downscale_row_fn_t)(const std::uint32_t *, const std::uint32_t *,
+                                   int, std::uint32_t *);
+
+/**
+ * @internal
+ * @brief averages dst_w pixels from two source rows. The caller guarantees
+ * 2 * dst_w source pixels are readable on both rows.
+ */
+void downscale_row_scalar(const std::uint32_t *r0, const std::uint32_t *r1,
+                          int dst_w, std::uint32_t *dst) {
+  for (int x = 0; x < dst_w; x++) {
+    std::uint32_t a = r0[2 * x], b = r0[2 * x + 1];
+    std::uint32_t c = r1[2 * x], d = r1[2 * x + 1];
+    std::uint32_t out = {};
+    for (int shift = 0; shift < 32; shift += 8) {
+      std::uint32_t sum = ((a >> shift) & 0xff) + ((b >> shift) & 0xff) +
+                          ((c >> shift) & 0xff) + ((d >> shift) & 0xff) + 2;
+      out |= (sum >> 2) << shift;
+    }
+    dst[x] = out;
+  }
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+
+__attribute__((target("sse2"))) void
+downscale_row_sse2(const std::uint32_t *r0, const std::uint32_t *r1,
+                   int dst_w, std::uint32_t *dst) {
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i two = _mm_set1_epi16(2);
+  int x = 0;
+
+  // four destination pixels from eight source pixels per row.
+  for (; x + 4 <= dst_w; x += 4) {
+    __m128i sum[2];
+    for (int i = 0; i < 2; i++) {
+      __m128i a = _mm_loadu_si128(
+          reinterpret_cast<const __m128i *>(r0 + 2 * x + 4 * i));
+      __m128i b = _mm_loadu_si128(
+          reinterpret_cast<const __m128i *>(r1 + 2 * x + 4 * i));
+      __m128i lo = _mm_add_epi16(_mm_unpacklo_epi8(a, zero),
+                                 _mm_unpacklo_epi8(b, zero));
+      __m128i hi = _mm_add_epi16(_mm_unpackhi_epi8(a, zero),
+                                 _mm_unpackhi_epi8(b, zero));
+      __m128i s = _mm_add_epi16(_mm_unpacklo_epi64(lo, hi),
+                                _mm_unpackhi_epi64(lo, hi));
+      sum[i] = _mm_srli_epi16(_mm_add_epi16(s, two), 2);
+    }
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + x),
+                     _mm_packus_epi16(sum[0], sum[1]));
+  }
+  downscale_row_scalar(r0 + 2 * x, r1 + 2 * x, dst_w - x, dst + x);
+}
+
+__attribute__((target("avx2"))) void
+downscale_row_avx2(const std::uint32_t *r0, const std::uint32_t *r1,
+                   int dst_w, std::uint32_t *dst) {
+  const __m256i zero = _mm256_setzero_si256();
+  const __m256i two = _mm256_set1_epi16(2);
+  int x = 0;
+
+  // eight destination pixels from sixteen source pixels per row. The unpack
+  // and pack instructions work within 128 bit lanes, the final permute puts
+  // the pixels back in order.
+  for (; x + 8 <= dst_w; x += 8) {
+    __m256i sum[2];
+    for (int i = 0; i < 2; i++) {
+      __m256i a = _mm256_loadu_si256(
+          reinterpret_cast<const __m256i *>(r0 + 2 * x + 8 * i));
+      __m256i b = _mm256_loadu_si256(
+          reinterpret_cast<const __m256i *>(r1 + 2 * x + 8 * i));
+      __m256i lo = _mm256_add_epi16(_mm256_unpacklo_epi8(a, zero),
+                                    _mm256_unpacklo_epi8(b, zero));
+      __m256i hi = _mm256_add_epi16(_mm256_unpackhi_epi8(a, zero),
+                                    _mm256_unpackhi_epi8(b, zero));
+      __m256i s = _mm256_add_epi16(_mm256_unpacklo_epi64(lo, hi),
+                                   _mm256_unpackhi_epi64(lo, hi));
+      sum[i] = _mm256_srli_epi16(_mm256_add_epi16(s, two), 2);
+    }
+    __m256i packed = _mm256_packus_epi16(sum[0], sum[1]);
+    packed = _mm256_permute4x64_epi64(packed, _MM_SHUFFLE(3, 1, 2, 0));
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + x), packed);
+  }
+  downscale_row_sse2(r0 + 2 * x, r1 + 2 * x, dst_w - x, dst + x);
+}
+
+#endif
+
+uxdevice::mip_kernel_t select_kernel(void) {
+#if defined(__x86_64__) || defined(__i386__)
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2"))
+    return uxdevice::mip_kernel_t::avx2;
+  if (__builtin_cpu_supports("sse2"))
+    return uxdevice::mip_kernel_t::sse2;
+#endif
+  return uxdevice::mip_kernel_t::scalar;
+}
+
+/// @brief the row kernel for kernel, no better than the cpu supports.
+downscale_row_fn_t row_kernel(uxdevice::mip_kernel_t kernel) {
+  uxdevice::mip_kernel_t supported = uxdevice::mip_kernel();
+  if (kernel == uxdevice::mip_kernel_t::automatic || kernel > supported)
+    kernel = supported;
+#if defined(__x86_64__) || defined(__i386__)
+  if (kernel == uxdevice::mip_kernel_t::avx2)
+    return downscale_row_avx2;
+  if (kernel == uxdevice::mip_kernel_t::sse2)
+    return downscale_row_sse2;
+#endif
+  return downscale_row_scalar;
+}
+
+} // namespace
+
+uxdevice::mip_kernel_t uxdevice::mip_kernel(void) {
+  static const mip_kernel_t kernel = select_kernel();
+  return kernel;
+}
+
+/**
+ * @internal
+ * @fn downscale_half
+ * @brief The kernels require two readable pixels per destination pixel. For
+ * odd widths the final destination pixel is computed from a replicated edge.
+ * For odd heights the final row is averaged with itself.
+ */
+void uxdevice::downscale_half(const std::uint32_t *src, int w, int h,
+                              int src_stride, std::uint32_t *dst,
+                              int dst_stride, mip_kernel_t kernel) {
+  downscale_row_fn_t fn_row = row_kernel(kernel);
+  int dst_w = (w + 1) / 2;
+  int dst_h = (h + 1) / 2;
+  int even_w = w / 2;
+
+  for (int y = 0; y < dst_h; y++) {
+    const std::uint32_t *r0 =
+        src + static_cast<std::size_t>(2 * y) * src_stride;
+    const std::uint32_t *r1 =
+        src + static_cast<std::size_t>(std::min(2 * y + 1, h - 1)) * src_stride;
+    std::uint32_t *out = dst + static_cast<std::size_t>(y) * dst_stride;
+
+    fn_row(r0, r1, even_w, out);
+
+    if (dst_w != even_w) {
+      std::uint32_t e0[2] = {r0[w - 1], r0[w - 1]};
+      std::uint32_t e1[2] = {r1[w - 1], r1[w - 1]};
+      downscale_row_scalar(e0, e1, 1, out + even_w);
+    }
+  }
+}
+
+uxdevice::mip_chain_t::mip_chain_t(const std::uint32_t *pixels, int width,
+                                   int height, int stride) {
+  mip_level_t base = {width, height, width, {}};
+  base.pixels.resize(static_cast<std::size_t>(width) * height);
+  for (int y = 0; y < height; y++)
+    std::copy_n(pixels + static_cast<std::size_t>(y) * stride, width,
+                base.pixels.data() + static_cast<std::size_t>(y) * width);
+  levels.emplace_back(std::move(base));
+
+  while (levels.back().width > 1 || levels.back().height > 1) {
+    const mip_level_t &prev = levels.back();
+    mip_level_t next = {};
+    next.width = (prev.width + 1) / 2;
+    next.height = (prev.height + 1) / 2;
+    next.stride = next.width;
+    next.pixels.resize(static_cast<std::size_t>(next.width) * next.height);
+    downscale_half(prev.pixels.data(), prev.width, prev.height, prev.stride,
+                   next.pixels.data(), next.stride);
+    levels.emplace_back(std::move(next));
+  }
+}
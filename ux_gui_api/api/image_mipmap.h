@@ -0,0 +1,123 @@
+/*
+ * This file is part of the ux_gui_stream distribution
+ * (https://github.com/amatarazzo777/ux_gui_stream).
+ * Copyright (c) 2020 Anthony Matarazzo.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+/**
+@author Anthony Matarazzo
+@file image_mipmap.h
+@date 10/27/20
+@version 1.0
+@details mip chains for decoded images. When an image_block_t is drawn much
+smaller than its source, sampling the full resolution image every frame with
+filter_options_t good or best is costly. The chain holds successive halvings
+of the image so the render visit can pick the level nearest to the drawn size
+and let cairo filter a source that is at most twice the destination.
+*/
+
+namespace uxdevice {
+
+/**
+ * @internal
+ * @struct mip_level_t
+ * @brief premultiplied ARGB32 pixels, the layout of CAIRO_FORMAT_ARGB32. The
+ * stride is in pixels.
+ */
+struct mip_level_t {
+  int width = {};
+  int height = {};
+  int stride = {};
+  std::vector<std::uint32_t> pixels = {};
+};
+
+/**
+ * @enum mip_kernel_t
+ * @brief the instruction set of a downscale kernel. automatic is the best
+ * one the cpu supports.
+ */
+enum class mip_kernel_t { automatic, scalar, sse2, avx2 };
+
+/**
+ * @internal
+ * @fn downscale_half
+ * @brief 2x2 box filter of src into dst. dst must be (w + 1) / 2 by
+ * (h + 1) / 2. The odd edge column and row are replicated. The AVX2 or SSE2
+ * kernel is selected at run time and produces the same bytes as the scalar
+ * kernel. A kernel the cpu does not support is lowered to one it does.
+ */
+void downscale_half(const std::uint32_t *src, int w, int h, int src_stride,
+                    std::uint32_t *dst, int dst_stride,
+                    mip_kernel_t kernel = mip_kernel_t::automatic);
+
+/// @brief the kernel selected for this cpu.
+mip_kernel_t mip_kernel(void);
+
+/**
+ * @internal
+ * @class mip_chain_t
+ * @brief level 0 is the source image, each following level is half the size
+ * of the previous down to one pixel. The chain is generated once when the
+ * image is decoded and stored beside it in the image cache.
+ */
+class mip_chain_t {
+public:
+  mip_chain_t() {}
+  mip_chain_t(const std::uint32_t *pixels, int width, int height,
+              int stride);
+
+  /**
+   * @fn level_for_scale
+   * @brief the index of the smallest level that is still at least as large as
+   * the drawn size. scale is destination size / source size, taken from the
+   * smaller axis of the current matrix_t.
+   */
+  std::size_t level_for_scale(double scale) const {
+    if (scale >= 1.0 || levels.empty())
+      return 0;
+    std::size_t n = 0;
+    while (n + 1 < levels.size() && scale <= 0.5) {
+      scale *= 2.0;
+      n++;
+    }
+    return n;
+  }
+
+  /**
+   * @fn level_scale
+   * @brief the scale to apply to a level so it is drawn at the size of level
+   * zero.
+   */
+  double level_scale(std::size_t n) const {
+    return static_cast<double>(levels[0].width) / levels[n].width;
+  }
+
+  const mip_level_t &level(std::size_t n) const { return levels[n]; }
+  std::size_t size(void) const { return levels.size(); }
+
+  /// @brief memory used by every level, charged against the image cache.
+  std::size_t bytes(void) const {
+    std::size_t ret = {};
+    for (auto &l : levels)
+      ret += l.pixels.size() * sizeof(std::uint32_t);
+    return ret;
+  }
+
+private:
+  std::vector<mip_level_t> levels = {};
+};
+
+} // namespace uxdevice
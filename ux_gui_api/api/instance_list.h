@@ -0,0 +1,187 @@
+/*
+ * This file is part of the ux_gui_stream distribution
+ * (https://github.com/amatarazzo777/ux_gui_stream).
+ * Copyright (c) 2020 Anthony Matarazzo.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+/**
+@author Anthony Matarazzo
+@file instance_list.h
+@date 10/30/20
+@version 1.0
+@details storage of the rectangle_list_t and arc_list_t units. Thousands of
+near identical shapes, the bars of a chart or the cells of a heat map, are
+given as parallel arrays and filled as one batch with a single state setup
+rather than as a rectangle_t and fill_path_t pair each.
+*/
+
+namespace uxdevice {
+
+/**
+ * @class instance_colors_t
+ * @brief the fill brush and per instance colors shared by the list units.
+ * When color is empty every instance is filled with the fill brush,
+ * otherwise color holds one entry per instance. An instance added without a
+ * color takes the fill color when the fill brush is solid. When it is a
+ * pattern, its color entry is unused and brushed is true for it, so it is
+ * painted with the pattern. Without a fill brush, such an instance is
+ * transparent.
+ */
+class instance_colors_t {
+public:
+  instance_colors_t() {}
+  instance_colors_t(const painter_brush_t &_fill) : fill(_fill) {}
+
+  std::vector<color_t> color = {};
+  std::vector<bool> brushed = {};
+  painter_brush_t fill = {};
+
+protected:
+  /// @brief gives the first n instances a color entry.
+  void backfill(std::size_t n) {
+    if (fill.type == painter_brush_t::brush_type_t::pattern)
+      brushed.resize(n, true);
+    color.resize(n, fill.is_solid() ? fill.color : color_t{});
+  }
+
+  /// @brief instance n - 1, the last added, has its own color c.
+  void colored(std::size_t n, const color_t &c) {
+    backfill(n);
+    if (brushed.size() >= n)
+      brushed[n - 1] = false;
+    color[n - 1] = c;
+  }
+};
+
+/**
+ * @class rectangle_list_storage_t
+ * @brief parallel arrays of x, y, width and height, with the colors of
+ * instance_colors_t.
+ */
+class rectangle_list_storage_t : public instance_colors_t {
+public:
+  using instance_colors_t::instance_colors_t;
+
+  void reserve(std::size_t n) {
+    x.reserve(n);
+    y.reserve(n);
+    width.reserve(n);
+    height.reserve(n);
+  }
+
+  rectangle_list_storage_t &add(double _x, double _y, double _w, double _h) {
+    x.push_back(_x);
+    y.push_back(_y);
+    width.push_back(_w);
+    height.push_back(_h);
+    if (!color.empty())
+      backfill(x.size());
+    return *this;
+  }
+
+  rectangle_list_storage_t &add(double _x, double _y, double _w, double _h,
+                                const color_t &_c) {
+    add(_x, _y, _w, _h);
+    colored(x.size(), _c);
+    return *this;
+  }
+
+  std::size_t size(void) const { return x.size(); }
+
+  /// @brief user space bounds of one instance, used to bin instances to
+  /// tiles and to cull them.
+  bounds_t bounds(std::size_t i) const {
+    return {std::min(x[i], x[i] + width[i]), std::min(y[i], y[i] + height[i]),
+            std::abs(width[i]), std::abs(height[i])};
+  }
+
+  std::vector<double> x = {};
+  std::vector<double> y = {};
+  std::vector<double> width = {};
+  std::vector<double> height = {};
+};
+
+/**
+ * @class arc_list_storage_t
+ * @brief parallel arrays of center and radius. angle1 and angle2 are empty
+ * for whole circles, which is the common case for scatter plots. The colors
+ * are those of instance_colors_t.
+ */
+class arc_list_storage_t : public instance_colors_t {
+public:
+  using instance_colors_t::instance_colors_t;
+
+  void reserve(std::size_t n) {
+    xc.reserve(n);
+    yc.reserve(n);
+    radius.reserve(n);
+  }
+
+  /// @brief a whole circle.
+  arc_list_storage_t &add(double _xc, double _yc, double _r) {
+    xc.push_back(_xc);
+    yc.push_back(_yc);
+    radius.push_back(_r);
+    if (!angle1.empty()) {
+      angle1.resize(xc.size(), 0);
+      angle2.resize(xc.size(), 2 * M_PI);
+    }
+    if (!color.empty())
+      backfill(xc.size());
+    return *this;
+  }
+
+  /// @brief a pie segment from angle1 to angle2, radians as cairo_arc.
+  arc_list_storage_t &add(double _xc, double _yc, double _r, double _a1,
+                          double _a2) {
+    add(_xc, _yc, _r);
+    angle1.resize(xc.size(), 0);
+    angle2.resize(xc.size(), 2 * M_PI);
+    angle1.back() = _a1;
+    angle2.back() = _a2;
+    return *this;
+  }
+
+  arc_list_storage_t &add(double _xc, double _yc, double _r,
+                          const color_t &_c) {
+    add(_xc, _yc, _r);
+    colored(xc.size(), _c);
+    return *this;
+  }
+
+  /// @brief a pie segment with its own color.
+  arc_list_storage_t &add(double _xc, double _yc, double _r, double _a1,
+                          double _a2, const color_t &_c) {
+    add(_xc, _yc, _r, _a1, _a2);
+    colored(xc.size(), _c);
+    return *this;
+  }
+
+  std::size_t size(void) const { return xc.size(); }
+
+  bounds_t bounds(std::size_t i) const {
+    return {xc[i] - radius[i], yc[i] - radius[i], 2 * radius[i],
+            2 * radius[i]};
+  }
+
+  std::vector<double> xc = {};
+  std::vector<double> yc = {};
+  std::vector<double> radius = {};
+  std::vector<double> angle1 = {};
+  std::vector<double> angle2 = {};
+};
+
+} // namespace uxdevice
@@ -0,0 +1,152 @@
+/*
+ * This file is part of the ux_gui_stream distribution
+ * (https://github.com/amatarazzo777/ux_gui_stream).
+ * Copyright (c) 2020 Anthony Matarazzo.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+/**
+@author Anthony Matarazzo
+@file interaction.h
+@date 11/3/20
+@version 1.0
+@details progressive quality. While the user drags, scrolls or resizes, frames
+are rendered with fast antialiasing and filtering, without shadow blur and
+with a coarser tolerance. When input has been idle for the configured time
+the surface is rendered once more at full quality. The library passes every
+event it dispatches to listeners through interaction_tracker_t, so the
+switch needs nothing from the application.
+*/
+
+namespace uxdevice {
+
+/**
+ * @internal
+ * @struct render_quality_t
+ * @brief settings that replace the context values for one frame. The unit
+ * values of antialias_t, the image filter and tollerance_t are overridden
+ * only while interactive is set.
+ */
+struct render_quality_t {
+  bool interactive = false;
+  antialias_options_t antialias = antialias_options_t::def;
+  filter_options_t filter = filter_options_t::good;
+  bool shadow_blur = true;
+  double tolerance_scale = 1.0;
+
+  static render_quality_t full(void) { return {}; }
+
+  static render_quality_t reduced(void) {
+    return {true, antialias_options_t::fast, filter_options_t::fast, false,
+            INTERACTION_TOLERANCE_SCALE};
+  }
+};
+
+/**
+ * @internal
+ * @class interaction_tracker_t
+ * @brief classifies the event stream. Pointer motion with a button held,
+ * wheel and resize events begin or extend an interaction. Motion without a
+ * button, clicks and keys do not, so hover effects render at full quality.
+ * Times are passed in so the render loop samples the clock once per frame.
+ */
+class interaction_tracker_t {
+public:
+  typedef std::chrono::steady_clock clock_t;
+
+  interaction_tracker_t(
+      std::chrono::milliseconds _idle =
+          std::chrono::milliseconds(INTERACTION_IDLE_MS))
+      : idle(_idle) {}
+
+  void set_mode(interaction_options_t _mode,
+                std::chrono::milliseconds _idle) {
+    mode = _mode;
+    idle = _idle;
+  }
+
+  /// @brief called by the event dispatch for every event.
+  void input(const event_t &e, clock_t::time_point now = clock_t::now()) {
+    if (e.type == std::type_index(typeid(listen_mousedown_t))) {
+      buttons_down = true;
+    } else if (e.type == std::type_index(typeid(listen_mouseup_t))) {
+      // the idle time of a drag is counted from the release.
+      buttons_down = false;
+      if (interacting)
+        touch(now);
+    } else if (e.type == std::type_index(typeid(listen_mousemove_t))) {
+      if (buttons_down)
+        touch(now);
+    } else if (e.type == std::type_index(typeid(listen_wheel_t)) ||
+               e.type == std::type_index(typeid(listen_resize_t))) {
+      touch(now);
+    }
+  }
+
+  /// @brief true while input is active and for idle time after it.
+  bool active(clock_t::time_point now = clock_t::now()) const {
+    return mode == interaction_options_t::automatic && interacting &&
+           (buttons_down || now - last < idle);
+  }
+
+  /**
+   * @fn quality
+   * @brief the settings for the frame about to be rendered.
+   */
+  render_quality_t quality(clock_t::time_point now = clock_t::now()) const {
+    return active(now) ? render_quality_t::reduced()
+                       : render_quality_t::full();
+  }
+
+  /**
+   * @fn settled
+   * @brief true once when an interaction has ended. The render loop then
+   * damages the whole surface so it is rendered again at full quality, even
+   * though no unit changed.
+   */
+  bool settled(clock_t::time_point now = clock_t::now()) {
+    if (!interacting || active(now))
+      return false;
+    interacting = false;
+    return true;
+  }
+
+  /**
+   * @fn deadline
+   * @brief when settled() will next become true, so an idle render loop can
+   * wait until then rather than poll.
+   */
+  std::optional<clock_t::time_point> deadline(void) const {
+    if (!interacting || buttons_down)
+      return {};
+    return last + idle;
+  }
+
+private:
+  void touch(clock_t::time_point now) {
+    if (mode != interaction_options_t::automatic)
+      return;
+    interacting = true;
+    last = now;
+  }
+
+  interaction_options_t mode = interaction_options_t::automatic;
+  std::chrono::milliseconds idle = {};
+  clock_t::time_point last = {};
+  bool interacting = false;
+  bool buttons_down = false;
+};
+
+} // namespace uxdevice
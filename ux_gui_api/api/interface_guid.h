@@ -37,6 +37,10 @@ interface_guid_t shared_resource_t = {0x96, 0x7d, 0x66, 0xbd, 0x44, 0x15,
                                       0xe9, 0x41, 0x93, 0x7c, 0x31, 0x8c,
                                       0x14, 0x03, 0xde, 0xf4};
 
+interface_guid_t versioned_resource_t = {0x3b, 0x6e, 0xa0, 0x58, 0xd2, 0x17,
+                                         0x4e, 0x90, 0x8c, 0x45, 0xf1, 0x2a,
+                                         0x69, 0xbe, 0x0c, 0x73};
+
 interface_guid_t display_unit_t = {0xd5, 0x06, 0x1b, 0xd0, 0x90, 0x6a,
                                    0x80, 0x4c, 0x81, 0x6f, 0xe5, 0x4d,
                                    0x2d, 0x9b, 0x0f, 0xd2};
@@ -200,12 +204,64 @@ interface_guid_t text_tab_stops_t = {0x51, 0x9f, 0x33, 0x25, 0xec, 0x00,
                                      0x4f, 0xee, 0xb7, 0xf2, 0x0d, 0x3a,
                                      0x8d, 0x9c, 0x31, 0x96};
 
+interface_guid_t frame_statistics_t = {0xf8, 0xd0, 0x40, 0x9b, 0x19, 0x81, 0x47,
+                                       0xf5, 0x99, 0x7a, 0xeb, 0x7b, 0x62, 0x37,
+                                       0x84, 0x1e};
+
+interface_guid_t fn_frame_statistics = {0xf6, 0xe7, 0x23, 0x23, 0x6f, 0xbf,
+                                        0x4e, 0xc4, 0x84, 0x80, 0x7e, 0xdd,
+                                        0x24, 0x97, 0x51, 0x1a};
+
+interface_guid_t fn_notify_changed = {0x2e, 0x94, 0xc7, 0x1a, 0x5b, 0x03,
+                                      0x4d, 0x8f, 0xa6, 0x61, 0x3c, 0xe9,
+                                      0x07, 0xb2, 0x5d, 0x14};
+
+interface_guid_t submission_policy_t = {0x81, 0x4a, 0xd6, 0x2f, 0x90, 0xe3,
+                                        0x47, 0x5b, 0xbc, 0x08, 0x6d, 0x17,
+                                        0xa2, 0xf9, 0x34, 0xc5};
+
+interface_guid_t z_order_t = {0x67, 0x0f, 0xb9, 0x42, 0xc8, 0x5d, 0x4a, 0x31,
+                              0x95, 0xe2, 0x1b, 0x7c, 0x03, 0xd4, 0xa8, 0x5e};
+
+interface_guid_t fn_push_layer = {0xd0, 0x3f, 0x19, 0x39, 0xaf, 0xae, 0x45,
+                                  0x21, 0xab, 0xd3, 0x48, 0xf5, 0x07, 0x25,
+                                  0x88, 0xdd};
+
+interface_guid_t packed_path_t = {0x5f, 0xd7, 0x60, 0xcf, 0xcc, 0x44, 0x43,
+                                  0x0d, 0xac, 0x42, 0x6e, 0x7b, 0xd4, 0x8a,
+                                  0x78, 0x0c};
+
+interface_guid_t rectangle_list_t = {0x93, 0xce, 0xa5, 0xdb, 0x1b, 0xb3, 0x4f,
+                                     0x3e, 0x96, 0x28, 0x7e, 0x16, 0x79, 0xc9,
+                                     0xff, 0x54};
+
+interface_guid_t arc_list_t = {0xbf, 0x47, 0x58, 0x20, 0x1b, 0x11, 0x4e, 0x50,
+                               0xa1, 0xe4, 0x76, 0xec, 0xb4, 0x20, 0x6c, 0x40};
+
+interface_guid_t render_mode_t = {0x2b, 0x8e, 0x61, 0xf4, 0x07, 0x9c, 0x4d,
+                                  0x52, 0x8a, 0x13, 0xc6, 0x5d, 0xe0, 0x47,
+                                  0x3b, 0x91};
+
+interface_guid_t interaction_mode_t = {0x7c, 0x30, 0xd5, 0x9e, 0x51, 0xa2,
+                                       0x48, 0x0b, 0x9f, 0x64, 0x2e, 0xb8,
+                                       0x13, 0xf7, 0xc6, 0x05};
+
+interface_guid_t text_layout_t = {0xa4, 0x19, 0xe2, 0x6b, 0x3f, 0x80, 0x4c,
+                                  0x27, 0xb5, 0x5e, 0x91, 0x0d, 0x68, 0xc3,
+                                  0x2a, 0xf6};
+interface_guid_t text_file_t = {0x5c, 0xd1, 0x07, 0x93, 0xe8, 0x2b, 0x41,
+                                0x6a, 0x9f, 0x33, 0xb4, 0x70, 0x1e, 0xa5,
+                                0xc6, 0x48};
+
 } // namespace interface_alias
 
 class raw_std_string_t {
 public:
   char *ptr = {};
   std::size_t size = {};
+  /// @brief the std::string of shared text. Edits reported by notify_changed
+  /// find their unit by it, as the data moves when the string reallocates.
+  const void *resource = {};
   interface_guid_t alias = interface_alias::link_table_entry_t;
 };
 
@@ -0,0 +1,152 @@
+/*
+ * This file is part of the ux_gui_stream distribution
+ * (https://github.com/amatarazzo777/ux_gui_stream).
+ * Copyright (c) 2020 Anthony Matarazzo.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+/**
+@author Anthony Matarazzo
+@file layer_cache.h
+@date 10/28/20
+@version 1.0
+@details retained layers. A group opened with fn_push_layer and
+layer_retain_options_t::retained is rendered once into an offscreen surface.
+While none of the units within the group change, later frames composite that
+surface with a single paint, including when only the translation of the
+matrix has changed by whole pixels. Layers are charged against a byte
+budget and a layer that has not been drawn for a number of frames is
+released.
+*/
+
+namespace uxdevice {
+
+/**
+ * @internal
+ * @class layer_cache_t
+ * @tparam SURFACE the offscreen surface, typically a wrapper around
+ * cairo_surface_t that releases it when destroyed.
+ * @brief id is the identity of the push unit within the display list.
+ * content_hash is the combined hash_code() of the units inside the group.
+ */
+template <typename SURFACE> class layer_cache_t {
+public:
+  typedef std::shared_ptr<SURFACE> surface_t;
+
+  struct layer_t {
+    surface_t surface = {};
+    std::size_t content_hash = {};
+    matrix_t matrix = {};
+    bounds_t bounds = {};
+    std::size_t bytes = {};
+    std::uint64_t last_frame = {};
+  };
+
+  layer_cache_t(std::size_t _budget, std::uint64_t _max_idle_frames)
+      : budget(_budget), max_idle_frames(_max_idle_frames) {}
+
+  /**
+   * @fn find
+   * @brief returns the layer when it may be composited in place of rendering
+   * the group. dx and dy receive the device translation to apply to the
+   * layer's bounds. A change of scale, rotation or content is a miss, as is
+   * a translation by a fraction of a pixel, which would resample the layer.
+   * A delta within a millionth of a whole pixel is snapped to it.
+   */
+  layer_t *find(std::size_t id, std::size_t content_hash, const matrix_t &m,
+                std::uint64_t frame, double &dx, double &dy) {
+    auto it = layers.find(id);
+    if (it == layers.end()) {
+      misses++;
+      return nullptr;
+    }
+    layer_t &l = it->second;
+    const cairo_matrix_t &a = l.matrix._matrix, &b = m._matrix;
+    if (l.content_hash != content_hash || a.xx != b.xx || a.yx != b.yx ||
+        a.xy != b.xy || a.yy != b.yy) {
+      misses++;
+      return nullptr;
+    }
+    double sx = std::round(b.x0 - a.x0), sy = std::round(b.y0 - a.y0);
+    if (std::abs(b.x0 - a.x0 - sx) > 1e-6 ||
+        std::abs(b.y0 - a.y0 - sy) > 1e-6) {
+      misses++;
+      return nullptr;
+    }
+    dx = sx;
+    dy = sy;
+    l.last_frame = frame;
+    hits++;
+    return &l;
+  }
+
+  /// @brief stores the rendered group then releases layers over the budget,
+  /// least recently drawn first.
+  void insert(std::size_t id, layer_t layer) {
+    auto it = layers.find(id);
+    if (it != layers.end())
+      used -= it->second.bytes;
+    used += layer.bytes;
+    layers[id] = std::move(layer);
+
+    while (used > budget && layers.size() > 1) {
+      auto oldest = layers.begin();
+      for (auto i = layers.begin(); i != layers.end(); i++)
+        if (i->second.last_frame < oldest->second.last_frame)
+          oldest = i;
+      release(oldest);
+    }
+  }
+
+  /// @brief called at the end of each frame to release idle layers.
+  void collect(std::uint64_t frame) {
+    for (auto it = layers.begin(); it != layers.end();) {
+      if (frame - it->second.last_frame > max_idle_frames)
+        it = release(it);
+      else
+        it++;
+    }
+  }
+
+  void erase(std::size_t id) {
+    auto it = layers.find(id);
+    if (it != layers.end())
+      release(it);
+  }
+
+  std::size_t bytes_used(void) const { return used; }
+  std::size_t size(void) const { return layers.size(); }
+
+  std::size_t hits = {};
+  std::size_t misses = {};
+  std::size_t evictions = {};
+
+private:
+  typedef typename std::unordered_map<std::size_t, layer_t>::iterator
+      iterator_t;
+
+  iterator_t release(iterator_t it) {
+    used -= it->second.bytes;
+    evictions++;
+    return layers.erase(it);
+  }
+
+  std::size_t budget = {};
+  std::uint64_t max_idle_frames = {};
+  std::size_t used = {};
+  std::unordered_map<std::size_t, layer_t> layers = {};
+};
+
+} // namespace uxdevice
@@ -34,7 +34,11 @@
  */
 class library_interface_linkage_t {
 public:
-  std::function<void(client_data_interface_base_t *)> fn_input_resource = {};
+  /// @brief the matrix and save levels of the inputting thread for the unit,
+  /// kept with it in its lane until the lanes are merged.
+  std::function<submit_result_t(client_data_interface_base_t *,
+                                const unit_transform_t &)>
+      fn_input_resource = {};
   std::function<void(std::size_t)> fn_linked_mapped_objects_find_size_t = {};
   std::function<void(char *, std::size_t)>
       fn_linked_mapped_objects_find_string = {};
@@ -43,6 +47,8 @@ public:
   std::function<void(void)> fn_restore;
   std::function<void(content_type_t &)> fn_push;
   std::function<void(bool)> fn_pop;
+  std::function<void(content_type_t &, layer_retain_options_t)>
+      fn_push_layer;
 
   std::function<void(double, double)> fn_scale;
   std::function<void(matrix_t &)> fn_transform;
@@ -60,4 +66,9 @@ public:
   std::function<void(double, double)> fn_user_distance;
 
   std::function<void(void)> fn_notify_complete;
+
+  std::function<void(frame_statistics_t &)> fn_frame_statistics;
+
+  std::function<void(raw_std_string_t *, const text_edit_t &)>
+      fn_notify_changed;
 }; // namespace uxdevice
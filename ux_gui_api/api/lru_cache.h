@@ -0,0 +1,135 @@
+/*
+ * This file is part of the ux_gui_stream distribution
+ * (https://github.com/amatarazzo777/ux_gui_stream).
+ * Copyright (c) 2020 Anthony Matarazzo.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+/**
+@author Anthony Matarazzo
+@file lru_cache.h
+@date 10/26/20
+@version 1.0
+@details least recently used cache bounded by a byte budget rather than an
+entry count. Decoded images vary from a few hundred bytes to many megabytes so
+the budget is the meaningful limit.
+*/
+
+namespace uxdevice {
+
+/**
+ * @internal
+ * @class lru_cache_t
+ * @tparam K key, requires std::hash.
+ * @tparam V value, stored as a shared pointer so an entry evicted while a
+ * render thread is drawing it stays alive until released.
+ * @brief thread safe. One instance is shared by all surfaces of the process.
+ */
+template <typename K, typename V> class lru_cache_t {
+public:
+  typedef std::shared_ptr<V> value_t;
+
+  lru_cache_t(std::size_t _budget) : budget(_budget) {}
+
+  lru_cache_t(const lru_cache_t &other) = delete;
+  lru_cache_t &operator=(const lru_cache_t &other) = delete;
+
+  /// @brief returns the entry and marks it most recently used.
+  value_t find(const K &key) {
+    std::lock_guard<std::mutex> guard(lock);
+    auto it = index.find(key);
+    if (it == index.end()) {
+      misses++;
+      return {};
+    }
+    entries.splice(entries.begin(), entries, it->second);
+    hits++;
+    return it->second->value;
+  }
+
+  /// @brief inserts or replaces the entry then evicts to the budget.
+  void insert(const K &key, value_t value, std::size_t bytes) {
+    std::lock_guard<std::mutex> guard(lock);
+    auto it = index.find(key);
+    if (it != index.end()) {
+      used -= it->second->bytes;
+      entries.erase(it->second);
+      index.erase(it);
+    }
+    entries.push_front(entry_t{key, value, bytes});
+    index[key] = entries.begin();
+    used += bytes;
+    evict();
+  }
+
+  void erase(const K &key) {
+    std::lock_guard<std::mutex> guard(lock);
+    auto it = index.find(key);
+    if (it == index.end())
+      return;
+    used -= it->second->bytes;
+    entries.erase(it->second);
+    index.erase(it);
+  }
+
+  void clear(void) {
+    std::lock_guard<std::mutex> guard(lock);
+    entries.clear();
+    index.clear();
+    used = 0;
+  }
+
+  void set_budget(std::size_t _budget) {
+    std::lock_guard<std::mutex> guard(lock);
+    budget = _budget;
+    evict();
+  }
+
+  std::size_t bytes_used(void) const {
+    std::lock_guard<std::mutex> guard(lock);
+    return used;
+  }
+
+  /// @brief read without the lock by the frame statistics.
+  std::atomic<std::size_t> hits = {};
+  std::atomic<std::size_t> misses = {};
+  std::atomic<std::size_t> evictions = {};
+
+private:
+  struct entry_t {
+    K key;
+    value_t value;
+    std::size_t bytes;
+  };
+
+  // the most recent entry is kept even when it alone exceeds the budget.
+  void evict(void) {
+    while (used > budget && entries.size() > 1) {
+      auto &e = entries.back();
+      used -= e.bytes;
+      index.erase(e.key);
+      entries.pop_back();
+      evictions++;
+    }
+  }
+
+  mutable std::mutex lock = {};
+  std::list<entry_t> entries = {};
+  std::unordered_map<K, typename std::list<entry_t>::iterator> index = {};
+  std::size_t budget = {};
+  std::size_t used = {};
+};
+
+} // namespace uxdevice
@@ -0,0 +1,224 @@
+/*
+ * This file is part of the ux_gui_stream distribution
+ * (https://github.com/amatarazzo777/ux_gui_stream).
+ * Copyright (c) 2020 Anthony Matarazzo.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @author Anthony Matarazzo
+ * @file mapped_file.cpp
+ * @date 10/26/20
+ * @version 1.0
+ * @brief posix implementation of the read only file mapping.
+ */
+#include <base/std_base.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "mapped_file.h"
+
+uxdevice::mapped_file_t::mapped_file_t(const std::string &_filename,
+                                       std::size_t _offset,
+                                       std::size_t _length, bool _map_pages) {
+  open(_filename, _offset, _length, _map_pages);
+}
+
+uxdevice::mapped_file_t::~mapped_file_t() { close(); }
+
+/// @brief move constructor
+uxdevice::mapped_file_t::mapped_file_t(mapped_file_t &&other) noexcept {
+  *this = std::move(other);
+}
+
+/// @brief move assignment
+uxdevice::mapped_file_t &
+uxdevice::mapped_file_t::operator=(mapped_file_t &&other) noexcept {
+  close();
+  filename = std::move(other.filename);
+  fd = other.fd;
+  base = other.base;
+  offset = other.offset;
+  page_offset = other.page_offset;
+  length = other.length;
+  requested_length = other.requested_length;
+  disk_size = other.disk_size;
+  device = other.device;
+  inode = other.inode;
+  map_pages = other.map_pages;
+
+  other.fd = -1;
+  other.base = {};
+  other.length = {};
+  return *this;
+}
+
+/**
+ * @internal
+ * @fn open
+ * @brief opens and maps the file. A length of zero maps from the offset to the
+ * end of the file. The mapping start is rounded down to the page size, the
+ * data() pointer accounts for the difference.
+ */
+void uxdevice::mapped_file_t::open(const std::string &_filename,
+                                   std::size_t _offset, std::size_t _length,
+                                   bool _map_pages) {
+  close();
+  filename = _filename;
+  offset = _offset;
+  requested_length = _length;
+  map_pages = _map_pages;
+
+  fd = ::open(filename.data(), O_RDONLY | O_CLOEXEC);
+  if (fd == -1) {
+    std::stringstream serror;
+    serror << "mapped_file_t could not open " << filename << ". "
+           << std::strerror(errno);
+    throw std::runtime_error(serror.str());
+  }
+
+  map();
+}
+
+void uxdevice::mapped_file_t::close(void) {
+  unmap();
+  if (fd != -1)
+    ::close(fd);
+  fd = -1;
+}
+
+/**
+ * @internal
+ * @fn refresh
+ * @brief called before the mapping is read. A file truncated below the end
+ * of the mapping is always remapped, as reading pages past the end of file
+ * raises SIGBUS. When follow is set, as for a log, growth is mapped and a
+ * path that names a different file, compared by device and inode, is
+ * opened again. The descriptor of a renamed file still refers to the old
+ * one, so its size alone would never show the rotation.
+ */
+uxdevice::mapped_file_t::change_t
+uxdevice::mapped_file_t::refresh(bool follow) {
+  if (fd == -1)
+    return change_t::none;
+
+  struct stat st = {};
+  if (follow && ::stat(filename.data(), &st) == 0 &&
+      (static_cast<std::uint64_t>(st.st_dev) != device ||
+       static_cast<std::uint64_t>(st.st_ino) != inode)) {
+    open(std::string(filename), offset, requested_length, map_pages);
+    return change_t::replaced;
+  }
+
+  if (fstat(fd, &st) == -1)
+    return change_t::none;
+
+  std::size_t now = static_cast<std::size_t>(st.st_size);
+  if (now < offset + length) {
+    unmap();
+    map();
+    return change_t::truncated;
+  }
+
+  if (!follow || now == disk_size)
+    return change_t::none;
+
+  unmap();
+  map();
+  return change_t::grown;
+}
+
+std::size_t uxdevice::mapped_file_t::read(std::size_t pos, char *out,
+                                          std::size_t n) const {
+  std::size_t done = {};
+  while (fd != -1 && done < n) {
+    ssize_t r = pread(fd, out + done, n - done,
+                      static_cast<off_t>(offset + pos + done));
+    if (r < 0 && errno == EINTR)
+      continue;
+    if (r <= 0)
+      break;
+    done += static_cast<std::size_t>(r);
+  }
+  return done;
+}
+
+bool uxdevice::mapped_file_t::truncated(void) const {
+  struct stat st = {};
+  if (fd == -1 || fstat(fd, &st) == -1)
+    return false;
+  return static_cast<std::size_t>(st.st_size) < offset + length;
+}
+
+void uxdevice::mapped_file_t::map(void) {
+  struct stat st = {};
+  if (fstat(fd, &st) == -1)
+    throw std::runtime_error("mapped_file_t fstat failed on " + filename);
+
+  disk_size = static_cast<std::size_t>(st.st_size);
+  device = static_cast<std::uint64_t>(st.st_dev);
+  inode = static_cast<std::uint64_t>(st.st_ino);
+  if (offset >= disk_size) {
+    length = 0;
+    return;
+  }
+
+  length = disk_size - offset;
+  if (requested_length && requested_length < length)
+    length = requested_length;
+  if (!map_pages)
+    return;
+
+  static const std::size_t page_size =
+      static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+  page_offset = offset - (offset % page_size);
+
+  void *p = mmap(nullptr, length + (offset - page_offset), PROT_READ,
+                 MAP_PRIVATE, fd, static_cast<off_t>(page_offset));
+  if (p == MAP_FAILED) {
+    length = 0;
+    throw std::runtime_error("mapped_file_t mmap failed on " + filename);
+  }
+
+  // no access pattern is advised. The line index is read front to back
+  // once, viewports then read at arbitrary positions, which prefetch()
+  // requests page by page.
+  base = static_cast<const char *>(p);
+}
+
+void uxdevice::mapped_file_t::unmap(void) {
+  if (base)
+    munmap(const_cast<char *>(base), length + (offset - page_offset));
+  base = {};
+  length = {};
+}
+
+/**
+ * @internal
+ * @fn prefetch
+ * @brief viewports of virtualized text read a few pages at arbitrary
+ * positions. The range is widened to page boundaries as madvise requires.
+ */
+void uxdevice::mapped_file_t::prefetch(std::size_t pos, std::size_t n) const {
+  if (!base || pos >= length)
+    return;
+  static const std::size_t page_size =
+      static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+  std::size_t begin = pos + (offset - page_offset);
+  std::size_t end = std::min(begin + n, length + (offset - page_offset));
+  begin -= begin % page_size;
+  madvise(const_cast<char *>(base) + begin, end - begin, MADV_WILLNEED);
+}
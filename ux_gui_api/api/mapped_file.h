@@ -0,0 +1,110 @@
+/*
+ * This file is part of the ux_gui_stream distribution
+ * (https://github.com/amatarazzo777/ux_gui_stream).
+ * Copyright (c) 2020 Anthony Matarazzo.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+/**
+@author Anthony Matarazzo
+@file mapped_file.h
+@date 10/26/20
+@version 1.0
+@details read only memory mapping of a file. Decoders read image and text
+sources directly from the page cache instead of copying the file into a heap
+buffer first.
+*/
+
+namespace uxdevice {
+
+/**
+ * @internal
+ * @class mapped_file_t
+ * @brief maps a file, or a region of one, read only. The mapping is released
+ * by the destructor. The object is movable but not copyable as it owns the
+ * descriptor and mapping. Opened with map_pages false, nothing is mapped,
+ * data() is nullptr and the region is read with read().
+ */
+class mapped_file_t {
+public:
+  /**
+   * @enum change_t
+   * @brief what refresh() found. grown and truncated are remapped at the new
+   * size. replaced means the path now names another file, as after log
+   * rotation renamed the old one away, and the new file was opened.
+   */
+  enum class change_t { none, grown, truncated, replaced };
+
+  mapped_file_t() {}
+  mapped_file_t(const std::string &_filename, std::size_t _offset = 0,
+                std::size_t _length = 0, bool _map_pages = true);
+  ~mapped_file_t();
+
+  mapped_file_t(const mapped_file_t &other) = delete;
+  mapped_file_t &operator=(const mapped_file_t &other) = delete;
+
+  /// @brief move constructor
+  mapped_file_t(mapped_file_t &&other) noexcept;
+
+  /// @brief move assignment
+  mapped_file_t &operator=(mapped_file_t &&other) noexcept;
+
+  void open(const std::string &_filename, std::size_t _offset = 0,
+            std::size_t _length = 0, bool _map_pages = true);
+  void close(void);
+
+  change_t refresh(bool follow = true);
+
+  /// @brief true when the file is now shorter than the mapped region, so
+  /// reading the tail of the mapping would fault. Costs one fstat.
+  bool truncated(void) const;
+
+  bool is_open(void) const { return fd != -1; }
+  const char *data(void) const {
+    return base ? base + (offset - page_offset) : nullptr;
+  }
+  std::size_t size(void) const { return length; }
+
+  /// @brief copies n bytes from pos of the region with pread. Returns the
+  /// bytes read, fewer when the file is now shorter. Unlike reading the
+  /// mapping, a concurrent truncation cannot fault.
+  std::size_t read(std::size_t pos, char *out, std::size_t n) const;
+
+  /// @brief the size of the file on disk at the last open or refresh.
+  std::size_t file_size(void) const { return disk_size; }
+
+  /// @brief asks the kernel to read the pages covering [pos, pos + n) of the
+  /// mapped region ahead of access.
+  void prefetch(std::size_t pos, std::size_t n) const;
+
+  std::string filename = {};
+
+private:
+  void map(void);
+  void unmap(void);
+
+  int fd = -1;
+  const char *base = {};
+  std::size_t offset = {};
+  std::size_t page_offset = {};
+  std::size_t length = {};
+  std::size_t requested_length = {};
+  std::size_t disk_size = {};
+  std::uint64_t device = {};
+  std::uint64_t inode = {};
+  bool map_pages = true;
+};
+
+} // namespace uxdevice
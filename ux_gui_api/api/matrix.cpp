@@ -0,0 +1,253 @@
+/*
+ * This file is part of the ux_gui_stream distribution
+ * (https://github.com/amatarazzo777/ux_gui_stream).
+ * Copyright (c) 2020 Anthony Matarazzo.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @author Anthony Matarazzo
+ * @file matrix.cpp
+ * @date 11/1/20
+ * @version 1.0
+ * @brief batch transforms for matrix_t. Every kernel evaluates
+ * (xx * x + xy * y) + x0 with separate multiplies and adds in the order cairo
+ * uses, without fused multiply add, so each result is bit identical to
+ * cairo_matrix_transform_point. Distances are not offset at all, adding a
+ * zero translation would turn -0.0 into 0.0 where cairo keeps -0.0.
+ * test/matrix_test.cpp compares every kernel with cairo.
+ */
+#include <base/std_base.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+#include "matrix.h"
+
+namespace {
+
+typedef void (*transform_fn_t)(const cairo_matrix_t &, double *, double *,
+                               std::size_t);
+typedef void (*interleaved_fn_t)(const cairo_matrix_t &, double *,
+                                 std::size_t);
+typedef void (*multiply_fn_t)(const cairo_matrix_t &, const cairo_matrix_t &,
+                              cairo_matrix_t &);
+
+// contraction is turned off for every kernel below. An fma rounds once where
+// cairo rounds after the multiply and again after the add.
+#if defined(__clang__)
+#pragma STDC FP_CONTRACT OFF
+#elif defined(__GNUC__)
+#pragma GCC push_options
+#pragma GCC optimize("fp-contract=off")
+#elif defined(_MSC_VER)
+#pragma fp_contract(off)
+#else
+#pragma STDC FP_CONTRACT OFF
+#endif
+
+template <bool TRANSLATE>
+void transform_scalar(const cairo_matrix_t &m, double *x, double *y,
+                      std::size_t n) {
+  for (std::size_t i = 0; i < n; i++) {
+    double nx = m.xx * x[i] + m.xy * y[i];
+    double ny = m.yx * x[i] + m.yy * y[i];
+    if constexpr (TRANSLATE) {
+      nx += m.x0;
+      ny += m.y0;
+    }
+    x[i] = nx;
+    y[i] = ny;
+  }
+}
+
+void transform_interleaved_scalar(const cairo_matrix_t &m, double *xy,
+                                  std::size_t n) {
+  for (std::size_t i = 0; i < n; i++) {
+    double x = xy[2 * i], y = xy[2 * i + 1];
+    double nx = m.xx * x + m.xy * y;
+    double ny = m.yx * x + m.yy * y;
+    xy[2 * i] = nx + m.x0;
+    xy[2 * i + 1] = ny + m.y0;
+  }
+}
+
+void multiply_scalar(const cairo_matrix_t &a, const cairo_matrix_t &b,
+                     cairo_matrix_t &r) {
+  cairo_matrix_t t = {};
+  t.xx = a.xx * b.xx + a.yx * b.xy;
+  t.yx = a.xx * b.yx + a.yx * b.yy;
+  t.xy = a.xy * b.xx + a.yy * b.xy;
+  t.yy = a.xy * b.yx + a.yy * b.yy;
+  t.x0 = a.x0 * b.xx + a.y0 * b.xy + b.x0;
+  t.y0 = a.x0 * b.yx + a.y0 * b.yy + b.y0;
+  r = t;
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+
+template <bool TRANSLATE>
+__attribute__((target("sse2"))) void
+transform_sse2(const cairo_matrix_t &m, double *x, double *y, std::size_t n) {
+  const __m128d xx = _mm_set1_pd(m.xx), xy = _mm_set1_pd(m.xy);
+  const __m128d yx = _mm_set1_pd(m.yx), yy = _mm_set1_pd(m.yy);
+  const __m128d x0 = _mm_set1_pd(m.x0), y0 = _mm_set1_pd(m.y0);
+  std::size_t i = 0;
+  for (; i + 2 <= n; i += 2) {
+    __m128d px = _mm_loadu_pd(x + i), py = _mm_loadu_pd(y + i);
+    __m128d nx = _mm_add_pd(_mm_mul_pd(xx, px), _mm_mul_pd(xy, py));
+    __m128d ny = _mm_add_pd(_mm_mul_pd(yx, px), _mm_mul_pd(yy, py));
+    if constexpr (TRANSLATE) {
+      nx = _mm_add_pd(nx, x0);
+      ny = _mm_add_pd(ny, y0);
+    }
+    _mm_storeu_pd(x + i, nx);
+    _mm_storeu_pd(y + i, ny);
+  }
+  transform_scalar<TRANSLATE>(m, x + i, y + i, n - i);
+}
+
+template <bool TRANSLATE>
+__attribute__((target("avx2"))) void
+transform_avx2(const cairo_matrix_t &m, double *x, double *y, std::size_t n) {
+  const __m256d xx = _mm256_set1_pd(m.xx), xy = _mm256_set1_pd(m.xy);
+  const __m256d yx = _mm256_set1_pd(m.yx), yy = _mm256_set1_pd(m.yy);
+  const __m256d x0 = _mm256_set1_pd(m.x0), y0 = _mm256_set1_pd(m.y0);
+  std::size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    __m256d px = _mm256_loadu_pd(x + i), py = _mm256_loadu_pd(y + i);
+    __m256d nx = _mm256_add_pd(_mm256_mul_pd(xx, px), _mm256_mul_pd(xy, py));
+    __m256d ny = _mm256_add_pd(_mm256_mul_pd(yx, px), _mm256_mul_pd(yy, py));
+    if constexpr (TRANSLATE) {
+      nx = _mm256_add_pd(nx, x0);
+      ny = _mm256_add_pd(ny, y0);
+    }
+    _mm256_storeu_pd(x + i, nx);
+    _mm256_storeu_pd(y + i, ny);
+  }
+  transform_sse2<TRANSLATE>(m, x + i, y + i, n - i);
+}
+
+/**
+ * @internal
+ * @brief interleaved points. Two points per register, the matrix columns are
+ * broadcast as (xx, yx) and (xy, yy) and x, y duplicated with unpack.
+ */
+__attribute__((target("sse2"))) void
+transform_interleaved_sse2(const cairo_matrix_t &m, double *xy,
+                           std::size_t n) {
+  const __m128d c0 = _mm_set_pd(m.yx, m.xx), c1 = _mm_set_pd(m.yy, m.xy);
+  const __m128d t = _mm_set_pd(m.y0, m.x0);
+  for (std::size_t i = 0; i < n; i++) {
+    __m128d p = _mm_loadu_pd(xy + 2 * i);
+    __m128d px = _mm_unpacklo_pd(p, p), py = _mm_unpackhi_pd(p, p);
+    __m128d r = _mm_add_pd(_mm_mul_pd(c0, px), _mm_mul_pd(c1, py));
+    _mm_storeu_pd(xy + 2 * i, _mm_add_pd(r, t));
+  }
+}
+
+/**
+ * @internal
+ * @brief cairo_matrix_t stores its members as the pairs (xx, yx), (xy, yy)
+ * and (x0, y0), so each row of the result is one register. A row of a is
+ * broadcast and multiplied with the first two rows of b, in the order of
+ * cairo_matrix_multiply. Both operands are loaded before the result is
+ * stored, so r may alias either.
+ */
+__attribute__((target("sse2"))) void
+multiply_sse2(const cairo_matrix_t &a, const cairo_matrix_t &b,
+              cairo_matrix_t &r) {
+  const __m128d b0 = _mm_loadu_pd(&b.xx), b1 = _mm_loadu_pd(&b.xy);
+  const __m128d b2 = _mm_loadu_pd(&b.x0);
+  const __m128d a0 = _mm_loadu_pd(&a.xx), a1 = _mm_loadu_pd(&a.xy);
+  const __m128d a2 = _mm_loadu_pd(&a.x0);
+  __m128d r0 = _mm_add_pd(_mm_mul_pd(_mm_unpacklo_pd(a0, a0), b0),
+                          _mm_mul_pd(_mm_unpackhi_pd(a0, a0), b1));
+  __m128d r1 = _mm_add_pd(_mm_mul_pd(_mm_unpacklo_pd(a1, a1), b0),
+                          _mm_mul_pd(_mm_unpackhi_pd(a1, a1), b1));
+  __m128d r2 = _mm_add_pd(_mm_mul_pd(_mm_unpacklo_pd(a2, a2), b0),
+                          _mm_mul_pd(_mm_unpackhi_pd(a2, a2), b1));
+  _mm_storeu_pd(&r.xx, r0);
+  _mm_storeu_pd(&r.xy, r1);
+  _mm_storeu_pd(&r.x0, _mm_add_pd(r2, b2));
+}
+
+#endif
+
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC pop_options
+#endif
+
+/**
+ * @internal
+ * @struct kernels_t
+ * @brief the kernels for this processor, selected once on first use.
+ */
+struct kernels_t {
+  transform_fn_t points = transform_scalar<true>;
+  transform_fn_t distances = transform_scalar<false>;
+  interleaved_fn_t interleaved = transform_interleaved_scalar;
+  multiply_fn_t multiply = multiply_scalar;
+};
+
+const kernels_t &kernels(void) {
+  static const kernels_t k = []() {
+    kernels_t ret = {};
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("sse2")) {
+      ret.points = transform_sse2<true>;
+      ret.distances = transform_sse2<false>;
+      ret.interleaved = transform_interleaved_sse2;
+      ret.multiply = multiply_sse2;
+    }
+    if (__builtin_cpu_supports("avx2")) {
+      ret.points = transform_avx2<true>;
+      ret.distances = transform_avx2<false>;
+    }
+#endif
+    return ret;
+  }();
+  return k;
+}
+
+} // namespace
+
+void uxdevice::matrix_t::transform_points(double *x, double *y,
+                                          std::size_t n) const {
+  kernels().points(_matrix, x, y, n);
+}
+
+void uxdevice::matrix_t::transform_distances(double *x, double *y,
+                                             std::size_t n) const {
+  kernels().distances(_matrix, x, y, n);
+}
+
+void uxdevice::matrix_t::transform_points(double *xy, std::size_t n) const {
+  kernels().interleaved(_matrix, xy, n);
+}
+
+void uxdevice::matrix_t::multiply(const matrix_t *a, const matrix_t *b,
+                                  matrix_t *result, std::size_t n) {
+  multiply_fn_t fn = kernels().multiply;
+  for (std::size_t i = 0; i < n; i++)
+    fn(a[i]._matrix, b[i]._matrix, result[i]._matrix);
+}
+
+void uxdevice::matrix_t::multiply(const matrix_t *a, matrix_t *result,
+                                  std::size_t n) const {
+  multiply_fn_t fn = kernels().multiply;
+  for (std::size_t i = 0; i < n; i++)
+    fn(a[i]._matrix, _matrix, result[i]._matrix);
+}
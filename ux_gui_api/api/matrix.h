@@ -66,9 +66,46 @@ public:
     double _x = x;
     double _y = y;
     cairo_matrix_transform_point(&_matrix, &_x, &_y);
-    x = _y;
+    x = _x;
     y = _y;
   }
+
+  /**
+   * @fn transform_points
+   * @brief transforms n points held as separate x and y arrays in place. The
+   * results are identical to calling cairo_matrix_transform_point for each
+   * point. AVX2 or SSE2 kernels are selected at run time.
+   */
+  void transform_points(double *x, double *y, std::size_t n) const;
+
+  /**
+   * @fn transform_points
+   * @brief transforms n points stored interleaved, x0 y0 x1 y1 ..., in place.
+   */
+  void transform_points(double *xy, std::size_t n) const;
+
+  /**
+   * @fn transform_distances
+   * @brief as transform_points without the translation, the same as
+   * cairo_matrix_transform_distance.
+   */
+  void transform_distances(double *x, double *y, std::size_t n) const;
+
+  /**
+   * @fn multiply
+   * @brief result[i] = a[i] * b[i] as cairo_matrix_multiply, for n matrices.
+   * result may be either operand. An SSE2 kernel is selected at run time.
+   */
+  static void multiply(const matrix_t *a, const matrix_t *b, matrix_t *result,
+                       std::size_t n);
+
+  /**
+   * @fn multiply
+   * @brief result[i] = a[i] * this, composing many child transforms with one
+   * parent.
+   */
+  void multiply(const matrix_t *a, matrix_t *result, std::size_t n) const;
+
   std::size_t hash_code(void) const noexcept {
     std::size_t __value = {};
     hash_combine(__value, _matrix.xx, _matrix.yx, _matrix.xy, _matrix.yy,
@@ -78,5 +115,23 @@ public:
 
   cairo_matrix_t _matrix = {0, 0, 0, 0, 0, 0};
 };
+
+/**
+ * @internal
+ * @fn scale_bucket
+ * @brief log2 of the larger axis scale of the matrix in quarter steps. Caches
+ * of scale dependent results, stroke outlines and simplified paths, key on
+ * the bucket so that small zoom changes reuse the entry.
+ */
+inline int scale_bucket(const matrix_t &m) {
+  const cairo_matrix_t &c = m._matrix;
+  double s = std::max(std::hypot(c.xx, c.yx), std::hypot(c.xy, c.yy));
+  return s > 0 ? static_cast<int>(std::floor(std::log2(s) * 4)) : 0;
+}
+
+/// @brief the largest scale within a bucket.
+inline double scale_bucket_limit(int bucket) {
+  return std::exp2((bucket + 1) / 4.0);
+}
 } // namespace uxdevice
 UX_REGISTER_STD_HASH_SPECIALIZATION(uxdevice::matrix_t)
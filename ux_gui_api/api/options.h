@@ -125,6 +125,151 @@ matrix is applied. Much slower but may look a bit better. Use either
 #define LINUX_XCB_CAIRO_PANGO_PROCESS_CHAIN
 #endif
 
+/**
+\def IMAGE_DECODE_THREADS
+\brief the number of threads in the image decode pool shared by all surfaces.
+Zero uses std::thread::hardware_concurrency().
+*/
+#define IMAGE_DECODE_THREADS 0
+
+/**
+\def IMAGE_CACHE_BUDGET
+\brief the byte budget of the decoded image cache shared by all surfaces. The
+least recently drawn images are released when it is exceeded.
+*/
+#define IMAGE_CACHE_BUDGET (256 * 1024 * 1024)
+
+/**
+\def RASTER_CACHE_BUDGET
+\brief the byte budget of the svg raster cache shared by all surfaces. Each
+entry is one svg source rendered at one size and antialias setting.
+*/
+#define RASTER_CACHE_BUDGET (64 * 1024 * 1024)
+
+/**
+\def LAYER_CACHE_BUDGET
+\brief the byte budget of the retained layers of one surface. Layers drawn
+least recently are released first when it is exceeded.
+*/
+#define LAYER_CACHE_BUDGET (128 * 1024 * 1024)
+
+/**
+\def LAYER_MAX_IDLE_FRAMES
+\brief a retained layer not drawn for this many frames is released.
+*/
+#define LAYER_MAX_IDLE_FRAMES 120
+
+/**
+\def STROKE_CACHE_BUDGET
+\brief the byte budget of the stroke outline and stroke mask caches of one
+surface, each.
+*/
+#define STROKE_CACHE_BUDGET (32 * 1024 * 1024)
+
+/**
+\def LOD_MIN_SEGMENTS
+\brief paths with at least this many segments are reduced for the current
+scale before drawing. See path_simplify.h.
+*/
+#define LOD_MIN_SEGMENTS 4096
+
+/**
+\def LOD_CACHE_BUDGET
+\brief the byte budget of reduced paths kept per surface.
+*/
+#define LOD_CACHE_BUDGET (64 * 1024 * 1024)
+
+/**
+\def RENDER_TILE_SIZE
+\brief the width and height in pixels of a tile when a surface renders with
+render_mode_options_t::tiled.
+*/
+#define RENDER_TILE_SIZE 256
+
+/**
+\def RENDER_THREADS
+\brief the number of threads that render the tiles of one surface, the
+rendering thread included. Zero uses std::thread::hardware_concurrency().
+*/
+#define RENDER_THREADS 0
+
+/**
+\def INTERACTION_IDLE_MS
+\brief milliseconds without drag, wheel or resize input after which a surface
+in interaction_options_t::automatic renders again at full quality.
+*/
+#define INTERACTION_IDLE_MS 150
+
+/**
+\def INTERACTION_TOLERANCE_SCALE
+\brief the factor applied to tollerance_t while interacting.
+*/
+#define INTERACTION_TOLERANCE_SCALE 4.0
+
+/**
+\def RESIZE_RELAYOUT_MS
+\brief during a live resize, text is laid out again at most once per this
+many milliseconds. Frames in between stretch the previous frame.
+*/
+#define RESIZE_RELAYOUT_MS 100
+
+/**
+\def RESIZE_SETTLE_MS
+\brief milliseconds without a resize event after which the final size is
+laid out.
+*/
+#define RESIZE_SETTLE_MS 50
+
+/**
+\def TEXT_LAYOUT_CACHE_BUDGET
+\brief the byte budget of the text layouts kept per surface, keyed by wrap
+width.
+*/
+#define TEXT_LAYOUT_CACHE_BUDGET (16 * 1024 * 1024)
+
+/**
+\def TEXT_INDEX_STRIDE
+\brief the line index of virtualized text records the offset of every
+TEXT_INDEX_STRIDE lines. Lines between are found by searching forward.
+*/
+#define TEXT_INDEX_STRIDE 64
+
+/**
+\def TEXT_OVERSCAN_LINES
+\brief lines laid out above and below the viewport of virtualized text so
+that small scrolls need no layout.
+*/
+#define TEXT_OVERSCAN_LINES 32
+
+/**
+\def TEXT_INDEX_SLICE
+\brief bytes of a text_file_t indexed per frame, so a large file is indexed
+over several frames while its first lines are already shown.
+*/
+#define TEXT_INDEX_SLICE (16 * 1024 * 1024)
+
+/**
+\def VERSIONED_RESOURCE_READERS
+\brief the reader slots of versioned_resource_t allocated at a time. Each
+render thread and tile worker that reads versioned data holds one slot,
+shared by all resources, from its first read until it exits. When all are
+held, another block of this many is added.
+*/
+#define VERSIONED_RESOURCE_READERS 64
+
+/**
+\def SUBMISSION_QUEUE_CAPACITY
+\brief units that may wait for the renderer before the submission policy
+applies.
+*/
+#define SUBMISSION_QUEUE_CAPACITY 4096
+
+/**
+\def SUBMISSION_LANE_BLOCK
+\brief entries in each block of a per thread submission lane.
+*/
+#define SUBMISSION_LANE_BLOCK 256
+
 /**
 \def USE_DEBUG_CONSOLE
 */
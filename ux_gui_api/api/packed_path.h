@@ -0,0 +1,233 @@
+/*
+ * This file is part of the ux_gui_stream distribution
+ * (https://github.com/amatarazzo777/ux_gui_stream).
+ * Copyright (c) 2020 Anthony Matarazzo.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+/**
+@author Anthony Matarazzo
+@file packed_path.h
+@date 10/30/20
+@version 1.0
+@details storage of the packed_path_t unit. A path of any length is held as
+one array of verbs and two arrays of coordinates, x and y, and crosses
+fn_input_resource once. It replaces a sequence of line_t, hline_t, vline_t,
+curve_t, arc_t, negative_arc_t and close_path_t units, each of which is a
+separate allocation and a separate library call.
+*/
+
+namespace uxdevice {
+
+/**
+ * @enum path_verb_t
+ * @brief the number of points each verb consumes from the coordinate arrays
+ * is move_to 1, line_to 1, curve_to 3 and close_path 0.
+ */
+enum class path_verb_t : std::uint8_t {
+  move_to,
+  line_to,
+  curve_to,
+  close_path
+};
+
+/**
+ * @class packed_path_storage_t
+ * @brief the builder functions keep the current point so that hline_to and
+ * vline_to can be stored as line_to. Arcs are converted to cubic bezier
+ * segments of at most a quarter turn, as cairo does internally, so every verb
+ * is expressed in points and the coordinate arrays can be transformed as a
+ * batch.
+ */
+class packed_path_storage_t {
+public:
+  packed_path_storage_t() {}
+
+  /// @brief a polyline from parallel coordinate arrays.
+  packed_path_storage_t(const double *_x, const double *_y, std::size_t n) {
+    polyline(_x, _y, n);
+  }
+
+  void reserve(std::size_t _verbs, std::size_t _points) {
+    verbs.reserve(_verbs);
+    x.reserve(_points);
+    y.reserve(_points);
+  }
+
+  void clear(void) {
+    verbs.clear();
+    x.clear();
+    y.clear();
+    cx = cy = sx = sy = 0;
+    hashed = false;
+  }
+
+  packed_path_storage_t &move_to(double _x, double _y) {
+    verbs.push_back(path_verb_t::move_to);
+    point(_x, _y);
+    sx = _x;
+    sy = _y;
+    return *this;
+  }
+
+  packed_path_storage_t &line_to(double _x, double _y) {
+    verbs.push_back(path_verb_t::line_to);
+    point(_x, _y);
+    return *this;
+  }
+
+  packed_path_storage_t &hline_to(double _x) { return line_to(_x, cy); }
+  packed_path_storage_t &vline_to(double _y) { return line_to(cx, _y); }
+
+  packed_path_storage_t &curve_to(double x1, double y1, double x2, double y2,
+                                  double x3, double y3) {
+    verbs.push_back(path_verb_t::curve_to);
+    point(x1, y1);
+    point(x2, y2);
+    point(x3, y3);
+    return *this;
+  }
+
+  /// @brief as cairo_arc, angles in radians increasing clockwise.
+  packed_path_storage_t &arc(double xc, double yc, double radius,
+                             double angle1, double angle2) {
+    while (angle2 < angle1)
+      angle2 += 2 * M_PI;
+    return arc_segments(xc, yc, radius, angle1, angle2);
+  }
+
+  /// @brief as cairo_arc_negative.
+  packed_path_storage_t &negative_arc(double xc, double yc, double radius,
+                                      double angle1, double angle2) {
+    while (angle2 > angle1)
+      angle2 -= 2 * M_PI;
+    return arc_segments(xc, yc, radius, angle1, angle2);
+  }
+
+  packed_path_storage_t &close_path(void) {
+    verbs.push_back(path_verb_t::close_path);
+    hashed = false;
+    cx = sx;
+    cy = sy;
+    return *this;
+  }
+
+  /// @brief appends a move_to and n - 1 line_to verbs in one pass.
+  packed_path_storage_t &polyline(const double *_x, const double *_y,
+                                  std::size_t n) {
+    if (n == 0)
+      return *this;
+    reserve(verbs.size() + n, x.size() + n);
+    move_to(_x[0], _y[0]);
+    verbs.insert(verbs.end(), n - 1, path_verb_t::line_to);
+    x.insert(x.end(), _x + 1, _x + n);
+    y.insert(y.end(), _y + 1, _y + n);
+    cx = _x[n - 1];
+    cy = _y[n - 1];
+    hashed = false;
+    return *this;
+  }
+
+  std::size_t size(void) const { return verbs.size(); }
+
+  /// @brief the same verbs and points. The hashes are compared first, so
+  /// paths that differ rarely walk the arrays.
+  bool operator==(const packed_path_storage_t &o) const {
+    return hash_code() == o.hash_code() && verbs == o.verbs && x == o.x &&
+           y == o.y;
+  }
+
+  /**
+   * @fn finalize
+   * @brief hashes the arrays once. Called when the unit is input, on the
+   * library copy, on a shared path and on each published version of a
+   * versioned one, so cache lookups while drawing do not walk the arrays.
+   * The builder functions clear the hash, a client that writes the arrays
+   * directly calls finalize() again afterwards.
+   */
+  void finalize(void) { rehash(); }
+
+  /// @brief the stored hash, computed here only when the path was changed
+  /// by a builder function since it was finalized.
+  std::size_t hash_code(void) const noexcept {
+    if (!hashed)
+      rehash();
+    return hash;
+  }
+
+  std::vector<path_verb_t> verbs = {};
+  std::vector<double> x = {};
+  std::vector<double> y = {};
+
+private:
+  void point(double _x, double _y) {
+    x.push_back(_x);
+    y.push_back(_y);
+    cx = _x;
+    cy = _y;
+    hashed = false;
+  }
+
+  /**
+   * @internal
+   * @brief the standard cubic approximation of a circular arc. A line_to the
+   * arc start is emitted when there is a current point, a move_to otherwise,
+   * matching cairo_arc.
+   */
+  packed_path_storage_t &arc_segments(double xc, double yc, double r,
+                                      double a1, double a2) {
+    double x0 = xc + r * std::cos(a1), y0 = yc + r * std::sin(a1);
+    if (verbs.empty())
+      move_to(x0, y0);
+    else
+      line_to(x0, y0);
+
+    int n = std::max(1, static_cast<int>(std::ceil(std::abs(a2 - a1) /
+                                                   (M_PI / 2))));
+    double step = (a2 - a1) / n;
+    double k = 4.0 / 3.0 * std::tan(step / 4);
+    for (int i = 0; i < n; i++) {
+      double t0 = a1 + step * i, t1 = t0 + step;
+      double c0 = std::cos(t0), s0 = std::sin(t0);
+      double c1 = std::cos(t1), s1 = std::sin(t1);
+      curve_to(xc + r * (c0 - k * s0), yc + r * (s0 + k * c0),
+               xc + r * (c1 + k * s1), yc + r * (s1 - k * c1), xc + r * c1,
+               yc + r * s1);
+    }
+    return *this;
+  }
+
+  void rehash(void) const noexcept {
+    hash = {};
+    hash_combine(hash, hash_bytes(verbs.data(), verbs.size()),
+                 hash_bytes(x.data(), x.size() * sizeof(double)),
+                 hash_bytes(y.data(), y.size() * sizeof(double)));
+    hashed = true;
+  }
+
+  static std::size_t hash_bytes(const void *p, std::size_t n) {
+    return std::hash<std::string_view>{}(
+        std::string_view(static_cast<const char *>(p), n));
+  }
+
+  double cx = {};
+  double cy = {};
+  double sx = {};
+  double sy = {};
+  mutable std::size_t hash = {};
+  mutable bool hashed = false;
+};
+
+} // namespace uxdevice
@@ -0,0 +1,393 @@
+/*
+ * This file is part of the ux_gui_stream distribution
+ * (https://github.com/amatarazzo777/ux_gui_stream).
+ * Copyright (c) 2020 Anthony Matarazzo.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+/**
+@author Anthony Matarazzo
+@file painter_brush.h
+@date 10/26/20
+@version 1.0
+@details The brush description used by text_color_t, surface_area_brush_t,
+fill_path_t, stroke_path_t and the other painting units. Solid colors, named
+or "#rrggbb[aa]", are decoded by constexpr functions so the unit carries four
+floats and the library performs no string parsing. A literal written with the
+_rgba suffix in a constant expression is decoded by the compiler, a
+description held in a string is decoded once when the brush is constructed,
+names through a hash table the compiler builds. Every other description,
+gradients and image patterns, is identified by a constexpr hash. The library
+interns the cairo pattern by that hash so that each is built once and shared by
+all units and surfaces that use the same description.
+*/
+
+namespace uxdevice {
+
+/**
+ * @internal
+ * @struct color_t
+ * @brief four floats in the range 0..1 as cairo_set_source_rgba expects.
+ */
+struct color_t {
+  float r = {};
+  float g = {};
+  float b = {};
+  float a = 1.0f;
+};
+
+namespace color_detail {
+
+/**
+ * @internal
+ * @struct named_color_t
+ * @brief entry of the constexpr named color table. The value is 0xrrggbb.
+ */
+struct named_color_t {
+  const char *name;
+  unsigned int rgb;
+};
+
+// clang-format off
+constexpr named_color_t named_colors[] = {
+    {"aliceblue", 0xf0f8ff},    {"antiquewhite", 0xfaebd7},
+    {"aqua", 0x00ffff},         {"aquamarine", 0x7fffd4},
+    {"azure", 0xf0ffff},        {"beige", 0xf5f5dc},
+    {"bisque", 0xffe4c4},       {"black", 0x000000},
+    {"blue", 0x0000ff},         {"blueviolet", 0x8a2be2},
+    {"brown", 0xa52a2a},        {"burlywood", 0xdeb887},
+    {"cadetblue", 0x5f9ea0},    {"chartreuse", 0x7fff00},
+    {"chocolate", 0xd2691e},    {"coral", 0xff7f50},
+    {"cornflowerblue", 0x6495ed}, {"cornsilk", 0xfff8dc},
+    {"crimson", 0xdc143c},      {"cyan", 0x00ffff},
+    {"darkblue", 0x00008b},     {"darkcyan", 0x008b8b},
+    {"darkgoldenrod", 0xb8860b}, {"darkgray", 0xa9a9a9},
+    {"darkgreen", 0x006400},    {"darkgrey", 0xa9a9a9},
+    {"darkkhaki", 0xbdb76b},    {"darkmagenta", 0x8b008b},
+    {"darkolivegreen", 0x556b2f}, {"darkorange", 0xff8c00},
+    {"darkorchid", 0x9932cc},   {"darkred", 0x8b0000},
+    {"darksalmon", 0xe9967a},   {"darkseagreen", 0x8fbc8f},
+    {"darkslateblue", 0x483d8b}, {"darkslategray", 0x2f4f4f},
+    {"darkturquoise", 0x00ced1}, {"darkviolet", 0x9400d3},
+    {"deeppink", 0xff1493},     {"deepskyblue", 0x00bfff},
+    {"dimgray", 0x696969},      {"dodgerblue", 0x1e90ff},
+    {"firebrick", 0xb22222},    {"floralwhite", 0xfffaf0},
+    {"forestgreen", 0x228b22},  {"fuchsia", 0xff00ff},
+    {"gainsboro", 0xdcdcdc},    {"ghostwhite", 0xf8f8ff},
+    {"gold", 0xffd700},         {"goldenrod", 0xdaa520},
+    {"gray", 0x808080},         {"green", 0x008000},
+    {"greenyellow", 0xadff2f},  {"grey", 0x808080},
+    {"honeydew", 0xf0fff0},     {"hotpink", 0xff69b4},
+    {"indianred", 0xcd5c5c},    {"indigo", 0x4b0082},
+    {"ivory", 0xfffff0},        {"khaki", 0xf0e68c},
+    {"lavender", 0xe6e6fa},     {"lavenderblush", 0xfff0f5},
+    {"lawngreen", 0x7cfc00},    {"lemonchiffon", 0xfffacd},
+    {"lightblue", 0xadd8e6},    {"lightcoral", 0xf08080},
+    {"lightcyan", 0xe0ffff},    {"lightgray", 0xd3d3d3},
+    {"lightgreen", 0x90ee90},   {"lightgrey", 0xd3d3d3},
+    {"lightpink", 0xffb6c1},    {"lightsalmon", 0xffa07a},
+    {"lightseagreen", 0x20b2aa}, {"lightskyblue", 0x87cefa},
+    {"lightslategray", 0x778899}, {"lightsteelblue", 0xb0c4de},
+    {"lightyellow", 0xffffe0},  {"lime", 0x00ff00},
+    {"limegreen", 0x32cd32},    {"linen", 0xfaf0e6},
+    {"magenta", 0xff00ff},      {"maroon", 0x800000},
+    {"mediumaquamarine", 0x66cdaa}, {"mediumblue", 0x0000cd},
+    {"mediumorchid", 0xba55d3}, {"mediumpurple", 0x9370db},
+    {"mediumseagreen", 0x3cb371}, {"mediumslateblue", 0x7b68ee},
+    {"mediumspringgreen", 0x00fa9a}, {"mediumturquoise", 0x48d1cc},
+    {"mediumvioletred", 0xc71585}, {"midnightblue", 0x191970},
+    {"mintcream", 0xf5fffa},    {"mistyrose", 0xffe4e1},
+    {"moccasin", 0xffe4b5},     {"navajowhite", 0xffdead},
+    {"navy", 0x000080},         {"oldlace", 0xfdf5e6},
+    {"olive", 0x808000},        {"olivedrab", 0x6b8e23},
+    {"orange", 0xffa500},       {"orangered", 0xff4500},
+    {"orchid", 0xda70d6},       {"palegoldenrod", 0xeee8aa},
+    {"palegreen", 0x98fb98},    {"paleturquoise", 0xafeeee},
+    {"palevioletred", 0xdb7093}, {"papayawhip", 0xffefd5},
+    {"peachpuff", 0xffdab9},    {"peru", 0xcd853f},
+    {"pink", 0xffc0cb},         {"plum", 0xdda0dd},
+    {"powderblue", 0xb0e0e6},   {"purple", 0x800080},
+    {"rebeccapurple", 0x663399}, {"red", 0xff0000},
+    {"rosybrown", 0xbc8f8f},    {"royalblue", 0x4169e1},
+    {"saddlebrown", 0x8b4513},  {"salmon", 0xfa8072},
+    {"sandybrown", 0xf4a460},   {"seagreen", 0x2e8b57},
+    {"seashell", 0xfff5ee},     {"sienna", 0xa0522d},
+    {"silver", 0xc0c0c0},       {"skyblue", 0x87ceeb},
+    {"slateblue", 0x6a5acd},    {"slategray", 0x708090},
+    {"snow", 0xfffafa},         {"springgreen", 0x00ff7f},
+    {"steelblue", 0x4682b4},    {"tan", 0xd2b48c},
+    {"teal", 0x008080},         {"thistle", 0xd8bfd8},
+    {"tomato", 0xff6347},       {"turquoise", 0x40e0d0},
+    {"violet", 0xee82ee},       {"wheat", 0xf5deb3},
+    {"white", 0xffffff},        {"whitesmoke", 0xf5f5f5},
+    {"yellow", 0xffff00},       {"yellowgreen", 0x9acd32}};
+// clang-format on
+
+constexpr char to_lower(char c) {
+  return (c >= 'A' && c <= 'Z') ? static_cast<char>(c - 'A' + 'a') : c;
+}
+
+constexpr bool equal_nocase(const char *a, const char *b) {
+  while (*a && *b && to_lower(*a) == to_lower(*b)) {
+    a++;
+    b++;
+  }
+  return *a == 0 && *b == 0;
+}
+
+constexpr int hex_digit(char c) {
+  if (c >= '0' && c <= '9')
+    return c - '0';
+  c = to_lower(c);
+  if (c >= 'a' && c <= 'f')
+    return c - 'a' + 10;
+  return -1;
+}
+
+constexpr float channel(unsigned int v, int shift) {
+  return static_cast<float>((v >> shift) & 0xff) / 255.0f;
+}
+
+constexpr std::size_t name_count =
+    sizeof(named_colors) / sizeof(named_colors[0]);
+
+/// @brief open addressing table of the indexes of named_colors, a power of
+/// two more than three times the number of names so probes are short.
+constexpr std::size_t name_slots = 512;
+
+constexpr std::uint32_t name_hash(const char *s) {
+  std::uint32_t h = 2166136261u;
+  for (; *s; s++) {
+    h ^= static_cast<unsigned char>(to_lower(*s));
+    h *= 16777619u;
+  }
+  return h;
+}
+
+struct name_table_t {
+  short slot[name_slots];
+};
+
+constexpr name_table_t build_name_table(void) {
+  name_table_t t = {};
+  for (std::size_t i = 0; i < name_slots; i++)
+    t.slot[i] = -1;
+  for (std::size_t i = 0; i < name_count; i++) {
+    std::size_t h = name_hash(named_colors[i].name) & (name_slots - 1);
+    while (t.slot[h] >= 0)
+      h = (h + 1) & (name_slots - 1);
+    t.slot[h] = static_cast<short>(i);
+  }
+  return t;
+}
+
+constexpr name_table_t name_table = build_name_table();
+
+/// @brief the entry named s, in any case, or nullptr.
+constexpr const named_color_t *find_name(const char *s) {
+  std::size_t h = name_hash(s) & (name_slots - 1);
+  for (; name_table.slot[h] >= 0; h = (h + 1) & (name_slots - 1)) {
+    const named_color_t &n = named_colors[name_table.slot[h]];
+    if (equal_nocase(n.name, s))
+      return &n;
+  }
+  return nullptr;
+}
+
+} // namespace color_detail
+
+/**
+ * @internal
+ * @fn parse_color
+ * @brief decodes a named color or "#rrggbb" / "#rrggbbaa" into the color
+ * parameter. Returns false when the text is not a solid color, which is the
+ * case for gradient and image pattern descriptions.
+ */
+constexpr bool parse_color(const char *s, color_t &color) {
+  if (s == nullptr)
+    return false;
+
+  if (s[0] == '#') {
+    unsigned int v = {};
+    int n = 0;
+    for (const char *p = s + 1; *p; p++, n++) {
+      int d = color_detail::hex_digit(*p);
+      if (d < 0)
+        return false;
+      v = (v << 4) | static_cast<unsigned int>(d);
+    }
+    if (n == 6) {
+      color = {color_detail::channel(v, 16), color_detail::channel(v, 8),
+               color_detail::channel(v, 0), 1.0f};
+      return true;
+    }
+    if (n == 8) {
+      color = {color_detail::channel(v, 24), color_detail::channel(v, 16),
+               color_detail::channel(v, 8), color_detail::channel(v, 0)};
+      return true;
+    }
+    return false;
+  }
+
+  const color_detail::named_color_t *n = color_detail::find_name(s);
+  if (!n)
+    return false;
+  color = {color_detail::channel(n->rgb, 16), color_detail::channel(n->rgb, 8),
+           color_detail::channel(n->rgb, 0), 1.0f};
+  return true;
+}
+
+/**
+ * @internal
+ * @fn brush_hash
+ * @brief constexpr FNV-1a of the description. The value is the interning key
+ * for patterns within the library.
+ */
+constexpr std::size_t brush_hash(const char *s) {
+  std::uint64_t h = 0xcbf29ce484222325ull;
+  for (; s && *s; s++) {
+    h ^= static_cast<unsigned char>(*s);
+    h *= 0x100000001b3ull;
+  }
+  return static_cast<std::size_t>(h);
+}
+
+/**
+ * @fn operator""_rgba
+ * @brief color literal, e.g. text_color_t{"steelblue"_rgba}. Initializing a
+ * constexpr color_t with it, constexpr color_t c = "steelblue"_rgba, has the
+ * compiler decode it and a misspelled literal fail to compile. Elsewhere an
+ * optimizing compiler folds it, or it throws std::invalid_argument.
+ */
+constexpr color_t operator""_rgba(const char *s, std::size_t) {
+  color_t c = {};
+  if (!parse_color(s, c))
+    throw std::invalid_argument("_rgba: not a named color or #rrggbb[aa]");
+  return c;
+}
+
+/**
+ * @class painter_brush_t
+ * @brief the brush carried by the painting units. When the description is a
+ * solid color, only the color is used and the library sets the source
+ * directly. Otherwise the description is shipped with its hash and the library
+ * looks the built pattern up in its interning table before parsing.
+ */
+class painter_brush_t {
+public:
+  enum class brush_type_t { none, solid, pattern };
+
+  painter_brush_t() {}
+
+  painter_brush_t(const color_t &c) : type(brush_type_t::solid), color(c) {}
+
+  painter_brush_t(double r, double g, double b, double a = 1.0)
+      : type(brush_type_t::solid),
+        color{static_cast<float>(r), static_cast<float>(g),
+              static_cast<float>(b), static_cast<float>(a)} {}
+
+  /// @brief decodes the description at run time. Use the _rgba suffix for
+  /// a literal color to have it decoded at compile time.
+  painter_brush_t(const char *s) {
+    if (!s)
+      return;
+    if (parse_color(s, color)) {
+      type = brush_type_t::solid;
+    } else {
+      type = brush_type_t::pattern;
+      description = s;
+      hash = brush_hash(s);
+    }
+  }
+
+  painter_brush_t(const std::string &s) : painter_brush_t(s.data()) {}
+
+  bool is_solid(void) const { return type == brush_type_t::solid; }
+
+  std::size_t hash_code(void) const noexcept {
+    std::size_t __value = {};
+    if (type == brush_type_t::solid)
+      hash_combine(__value, color.r, color.g, color.b, color.a);
+    else
+      hash_combine(__value, hash);
+    return __value;
+  }
+
+  brush_type_t type = brush_type_t::none;
+  color_t color = {};
+  std::string description = {};
+  std::size_t hash = {};
+};
+
+/**
+ * @internal
+ * @class pattern_intern_table_t
+ * @tparam T the pattern resource the library constructs, typically a wrapper
+ * around cairo_pattern_t that releases the reference when destroyed.
+ * @brief patterns keyed by painter_brush_t::hash. A hit is confirmed by
+ * comparing the description, so descriptions whose hashes collide each have
+ * their own pattern. The factory runs only when the description has not been
+ * seen, so a gradient is built once and the same
+ * instance is handed to every unit and surface that names it. Entries are
+ * held weakly so a pattern that no unit references is released.
+ */
+template <typename T> class pattern_intern_table_t {
+public:
+  template <typename FN>
+  std::shared_ptr<T> acquire(const painter_brush_t &brush, FN &&fn_create) {
+    std::lock_guard<std::mutex> guard(lock);
+    auto range = patterns.equal_range(brush.hash);
+    auto it = std::find_if(range.first, range.second, [&](auto &n) {
+      return n.second.description == brush.description;
+    });
+    if (it != range.second) {
+      if (auto p = it->second.pattern.lock())
+        return p;
+    }
+    std::shared_ptr<T> p = fn_create(brush.description);
+    if (it != range.second)
+      it->second.pattern = p;
+    else
+      patterns.emplace(brush.hash, entry_t{brush.description, p});
+    return p;
+  }
+
+  /// @brief removes entries whose pattern is no longer referenced.
+  void collect(void) {
+    std::lock_guard<std::mutex> guard(lock);
+    for (auto it = patterns.begin(); it != patterns.end();) {
+      if (it->second.pattern.expired())
+        it = patterns.erase(it);
+      else
+        it++;
+    }
+  }
+
+  std::size_t size(void) const {
+    std::lock_guard<std::mutex> guard(lock);
+    return patterns.size();
+  }
+
+private:
+  struct entry_t {
+    std::string description = {};
+    std::weak_ptr<T> pattern = {};
+  };
+
+  mutable std::mutex lock = {};
+  std::unordered_multimap<std::size_t, entry_t> patterns = {};
+};
+
+} // namespace uxdevice
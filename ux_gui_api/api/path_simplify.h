@@ -0,0 +1,284 @@
+/*
+ * This file is part of the ux_gui_stream distribution
+ * (https://github.com/amatarazzo777/ux_gui_stream).
+ * Copyright (c) 2020 Anthony Matarazzo.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+/**
+@author Anthony Matarazzo
+@file path_simplify.h
+@date 10/31/20
+@version 1.0
+@details level of detail for large paths. When a path of millions of segments
+is drawn zoomed out, most segments are smaller than a pixel. The path is
+reduced for the current scale before it reaches cairo. Curves are flattened
+with as few segments as the tolerance allows, then runs of lines are reduced
+with Douglas-Peucker. The error in device units stays within the
+tollerance_t value. Results are cached per scale bucket.
+*/
+
+namespace uxdevice {
+
+/**
+ * @internal
+ * @class path_simplifier_t
+ * @brief epsilon is the allowed deviation in user units. It is derived from
+ * the device tolerance and the largest scale of the bucket so one result is
+ * valid for every matrix in the bucket.
+ */
+class path_simplifier_t {
+public:
+  /// @brief the smallest epsilon used, a tolerance of zero would otherwise
+  /// divide by zero when curves are flattened.
+  static constexpr double min_epsilon = 1e-9;
+
+  static double epsilon(double tolerance, int bucket) {
+    return std::max(tolerance / scale_bucket_limit(bucket), min_epsilon);
+  }
+
+  /**
+   * @fn simplify
+   * @brief returns the reduced path. Verbs other than line runs and curves
+   * are copied. A subpath is never reduced below its end points. The
+   * flattened points of a curve lie within eps / 2 of it and the reduced
+   * run within eps / 2 of the flattened points, so the result is within eps
+   * of the source. A line_to or curve_to without a current point begins a
+   * subpath at its first point, as in cairo.
+   */
+  static packed_path_storage_t simplify(const packed_path_storage_t &src,
+                                        double eps) {
+    packed_path_storage_t dst = {};
+    double half = std::max(eps, min_epsilon) / 2;
+    std::vector<double> rx = {}, ry = {};
+    std::size_t p = 0;
+    double sx = {}, sy = {};
+
+    auto flush = [&]() {
+      if (rx.size() > 1)
+        reduce(rx, ry, half, dst);
+      if (!rx.empty()) {
+        double lx = rx.back(), ly = ry.back();
+        rx.assign(1, lx);
+        ry.assign(1, ly);
+      }
+    };
+
+    for (auto v : src.verbs) {
+      if (rx.empty() && v != path_verb_t::move_to &&
+          v != path_verb_t::close_path) {
+        sx = src.x[p];
+        sy = src.y[p];
+        dst.move_to(sx, sy);
+        rx.assign(1, sx);
+        ry.assign(1, sy);
+        if (v == path_verb_t::line_to) {
+          p++;
+          continue;
+        }
+      }
+
+      switch (v) {
+      case path_verb_t::move_to:
+        flush();
+        sx = src.x[p];
+        sy = src.y[p];
+        dst.move_to(sx, sy);
+        rx.assign(1, sx);
+        ry.assign(1, sy);
+        p++;
+        break;
+      case path_verb_t::line_to:
+        rx.push_back(src.x[p]);
+        ry.push_back(src.y[p]);
+        p++;
+        break;
+      case path_verb_t::curve_to:
+        flatten(rx.back(), ry.back(), &src.x[p], &src.y[p], half, rx, ry);
+        p += 3;
+        break;
+      case path_verb_t::close_path:
+        flush();
+        dst.close_path();
+        rx.assign(1, sx);
+        ry.assign(1, sy);
+        break;
+      }
+    }
+    flush();
+    return dst;
+  }
+
+private:
+  /**
+   * @internal
+   * @brief appends the points of a cubic from (x0, y0). The segment count
+   * bounds the chord deviation, 3/4 of the largest second difference of the
+   * control points divided by n squared, by eps.
+   */
+  static void flatten(double x0, double y0, const double *cx,
+                      const double *cy, double eps, std::vector<double> &rx,
+                      std::vector<double> &ry) {
+    double ddx = std::max(std::abs(x0 - 2 * cx[0] + cx[1]),
+                          std::abs(cx[0] - 2 * cx[1] + cx[2]));
+    double ddy = std::max(std::abs(y0 - 2 * cy[0] + cy[1]),
+                          std::abs(cy[0] - 2 * cy[1] + cy[2]));
+    double dd = std::hypot(ddx, ddy);
+    double segments = std::ceil(std::sqrt(0.75 * dd / eps));
+    int n = segments >= 1 ? static_cast<int>(std::min(segments, 1024.0)) : 1;
+
+    for (int i = 1; i <= n; i++) {
+      double t = static_cast<double>(i) / n, u = 1 - t;
+      double a = u * u * u, b = 3 * u * u * t;
+      double c = 3 * u * t * t, d = t * t * t;
+      rx.push_back(a * x0 + b * cx[0] + c * cx[1] + d * cx[2]);
+      ry.push_back(a * y0 + b * cy[0] + c * cy[1] + d * cy[2]);
+    }
+  }
+
+  /**
+   * @internal
+   * @brief Douglas-Peucker over the run, the first point already emitted.
+   * Iterative with an explicit stack as runs may hold millions of points.
+   * The distance is to the segment rather than its line, so a point beyond
+   * either end of the segment, as where a run doubles back, is kept.
+   */
+  static void reduce(const std::vector<double> &x,
+                     const std::vector<double> &y, double eps,
+                     packed_path_storage_t &dst) {
+    std::size_t n = x.size();
+    std::vector<bool> keep(n, false);
+    keep[0] = keep[n - 1] = true;
+
+    std::vector<std::pair<std::size_t, std::size_t>> stack = {{0, n - 1}};
+    double eps2 = eps * eps;
+    while (!stack.empty()) {
+      auto [a, b] = stack.back();
+      stack.pop_back();
+      if (b <= a + 1)
+        continue;
+
+      double dx = x[b] - x[a], dy = y[b] - y[a];
+      double len2 = dx * dx + dy * dy;
+      double worst = -1;
+      std::size_t index = a;
+      for (std::size_t i = a + 1; i < b; i++) {
+        double px = x[i] - x[a], py = y[i] - y[a];
+        double t = len2 == 0 ? 0 : (px * dx + py * dy) / len2;
+        t = std::clamp(t, 0.0, 1.0);
+        double ex = px - t * dx, ey = py - t * dy;
+        double d2 = ex * ex + ey * ey;
+        if (d2 > worst) {
+          worst = d2;
+          index = i;
+        }
+      }
+
+      if (worst > eps2) {
+        keep[index] = true;
+        stack.push_back({a, index});
+        stack.push_back({index, b});
+      }
+    }
+
+    for (std::size_t i = 1; i < n; i++)
+      if (keep[i])
+        dst.line_to(x[i], y[i]);
+  }
+};
+
+/**
+ * @internal
+ * @struct simplified_key_t
+ * @brief a reduced path is valid for one source path, scale bucket and
+ * tolerance. The source is compared on a hit, its hash only selects the
+ * bucket. A key made for a lookup points at the caller's path without
+ * owning it. The cache stores owned() copies.
+ */
+struct simplified_key_t {
+  std::shared_ptr<const packed_path_storage_t> path = {};
+  int bucket = {};
+  double tolerance = {};
+
+  bool operator==(const simplified_key_t &o) const {
+    return bucket == o.bucket && tolerance == o.tolerance && *path == *o.path;
+  }
+
+  /// @brief the key with its own copy of the path.
+  simplified_key_t owned(void) const {
+    return {std::make_shared<const packed_path_storage_t>(*path), bucket,
+            tolerance};
+  }
+
+  std::size_t hash_code(void) const noexcept {
+    std::size_t __value = {};
+    hash_combine(__value, path->hash_code(), bucket, tolerance);
+    return __value;
+  }
+};
+
+} // namespace uxdevice
+
+template <> struct std::hash<uxdevice::simplified_key_t> {
+  std::size_t operator()(const uxdevice::simplified_key_t &k) const noexcept {
+    return k.hash_code();
+  }
+};
+
+namespace uxdevice {
+
+/**
+ * @internal
+ * @class simplified_path_cache_t
+ * @brief reduced paths per scale bucket. Paths with fewer segments than
+ * LOD_MIN_SEGMENTS are drawn as given since the reduction would cost more
+ * than it saves.
+ */
+class simplified_path_cache_t {
+public:
+  typedef std::shared_ptr<packed_path_storage_t> path_t;
+
+  simplified_path_cache_t(std::size_t _budget) : cache(_budget) {}
+
+  /// @brief returns nullptr when the source path should be drawn unchanged.
+  /// The copy of the source kept in the key is charged with the result.
+  path_t acquire(const packed_path_storage_t &src, const matrix_t &m,
+                 double tolerance) {
+    if (src.size() < LOD_MIN_SEGMENTS)
+      return {};
+
+    simplified_key_t key = {
+        std::shared_ptr<const packed_path_storage_t>(std::shared_ptr<void>(),
+                                                     &src),
+        scale_bucket(m), tolerance};
+    if (auto p = cache.find(key))
+      return p;
+
+    auto p = std::make_shared<packed_path_storage_t>(
+        path_simplifier_t::simplify(
+            src, path_simplifier_t::epsilon(tolerance, key.bucket)));
+    cache.insert(key.owned(), p, bytes(*p) + bytes(src));
+    return p;
+  }
+
+private:
+  static std::size_t bytes(const packed_path_storage_t &p) {
+    return p.verbs.size() + 2 * p.x.size() * sizeof(double);
+  }
+
+  lru_cache_t<simplified_key_t, packed_path_storage_t> cache;
+};
+
+} // namespace uxdevice
@@ -0,0 +1,198 @@
+/*
+ * This file is part of the ux_gui_stream distribution
+ * (https://github.com/amatarazzo777/ux_gui_stream).
+ * Copyright (c) 2020 Anthony Matarazzo.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+/**
+@author Anthony Matarazzo
+@file raster_cache.h
+@date 10/27/20
+@version 1.0
+@details rasterized svg documents keyed by source and target size. An icon
+given to image_block_t as svg is rendered by librsvg once per distinct size and
+antialias setting. Later draws of the same icon, on any surface, paint the
+cached raster.
+*/
+
+namespace uxdevice {
+
+/**
+ * @internal
+ * @struct raster_key_t
+ * @brief identity of one rasterization. source_hash is the hash of the svg
+ * document text, not its file name, so two units that name the same document
+ * share the entry. As a hash may collide, the cache confirms a hit by
+ * comparing the source text.
+ */
+struct raster_key_t {
+  std::size_t source_hash = {};
+  int width = {};
+  int height = {};
+  antialias_options_t antialias = antialias_options_t::def;
+
+  bool operator==(const raster_key_t &other) const {
+    return source_hash == other.source_hash && width == other.width &&
+           height == other.height && antialias == other.antialias;
+  }
+
+  std::size_t hash_code(void) const noexcept {
+    std::size_t __value = {};
+    hash_combine(__value, source_hash, width, height,
+                 static_cast<int>(antialias));
+    return __value;
+  }
+};
+
+} // namespace uxdevice
+
+template <> struct std::hash<uxdevice::raster_key_t> {
+  std::size_t operator()(const uxdevice::raster_key_t &k) const noexcept {
+    return k.hash_code();
+  }
+};
+
+namespace uxdevice {
+
+/**
+ * @internal
+ * @class raster_cache_t
+ * @tparam IMAGE the raster, typically a wrapper of an image cairo_surface_t.
+ * @brief one instance is shared by all surfaces of the process. A miss
+ * rasterizes on the pool and every concurrent requester of the same key waits
+ * on that one result. prefetch() rasterizes a set of keys in parallel so a
+ * window that opens with many icons does not rasterize them one at a time on
+ * the render thread. A source that fails to rasterize is remembered for its
+ * key, so it is not rasterized again every frame until retry().
+ */
+template <typename IMAGE> class raster_cache_t {
+public:
+  typedef std::shared_ptr<IMAGE> image_t;
+
+  /// @brief the source is kept with the raster to confirm a hit.
+  struct entry_t {
+    std::string source = {};
+    image_t image = {};
+  };
+
+  /// @brief renders the svg source at the key's size, returning the raster
+  /// and its size in bytes.
+  typedef std::function<std::pair<image_t, std::size_t>(
+      const std::string &, const raster_key_t &)>
+      rasterize_fn_t;
+
+  raster_cache_t(rasterize_fn_t _rasterize, std::size_t _threads,
+                 std::size_t _budget)
+      : rasterize(_rasterize), cache(_budget), pool(_threads) {}
+
+  /**
+   * @fn acquire
+   * @brief returns the raster, rasterizing it on the pool on first use. The
+   * calling thread blocks only for the key it asked for.
+   */
+  image_t acquire(const std::string &source, const raster_key_t &key) {
+    if (auto e = cache.find(key))
+      if (e->source == source)
+        return e->image;
+    return schedule(source, key).get();
+  }
+
+  /**
+   * @fn prefetch
+   * @brief queues rasterization of every key not yet cached. Returns without
+   * waiting.
+   */
+  void prefetch(const std::vector<std::pair<std::string, raster_key_t>> &keys) {
+    for (auto &k : keys) {
+      auto e = cache.find(k.second);
+      if (!e || e->source != k.first)
+        schedule(k.first, k.second);
+    }
+  }
+
+  /// @brief forgets a failed rasterization so the next acquire tries again.
+  void retry(const raster_key_t &key) {
+    std::lock_guard<std::mutex> guard(lock);
+    failed.erase(key);
+  }
+
+  lru_cache_t<raster_key_t, entry_t> &rasters(void) { return cache; }
+
+private:
+  std::shared_future<image_t> schedule(const std::string &source,
+                                       const raster_key_t &key) {
+    std::lock_guard<std::mutex> guard(lock);
+    auto fit = failed.find(key);
+    if (fit != failed.end() && fit->second == source) {
+      std::promise<image_t> none = {};
+      none.set_value({});
+      return none.get_future().share();
+    }
+
+    auto range = inflight.equal_range(key);
+    auto it = std::find_if(range.first, range.second,
+                           [&](auto &n) { return n.second.source == source; });
+    if (it != range.second)
+      return it->second.result;
+
+    std::shared_future<image_t> f =
+        pool.submit([this, source, key]() {
+              image_t ret = {};
+              try {
+                auto result = rasterize(source, key);
+                ret = result.first;
+                if (ret)
+                  cache.insert(key,
+                               std::make_shared<entry_t>(entry_t{source, ret}),
+                               result.second + source.size());
+              } catch (...) {
+              }
+              std::lock_guard<std::mutex> guard(lock);
+              if (ret)
+                failed.erase(key);
+              else
+                failed[key] = source;
+              auto r = inflight.equal_range(key);
+              for (auto n = r.first; n != r.second; n++)
+                if (n->second.source == source) {
+                  inflight.erase(n);
+                  break;
+                }
+              return ret;
+            })
+            .share();
+    inflight.emplace(key, inflight_t{source, f});
+    return f;
+  }
+
+  rasterize_fn_t rasterize = {};
+  lru_cache_t<raster_key_t, entry_t> cache;
+  std::mutex lock = {};
+
+  /// @brief rasterizations in progress, joined by key and source so that
+  /// sources whose hashes collide are not handed each other's raster.
+  struct inflight_t {
+    std::string source = {};
+    std::shared_future<image_t> result = {};
+  };
+  std::unordered_multimap<raster_key_t, inflight_t> inflight = {};
+  std::unordered_map<raster_key_t, std::string> failed = {};
+
+  // the pool is destroyed first, its tasks use the cache and inflight map.
+  thread_pool_t pool;
+};
+
+} // namespace uxdevice
@@ -0,0 +1,238 @@
+/*
+ * This file is part of the ux_gui_stream distribution
+ * (https://github.com/amatarazzo777/ux_gui_stream).
+ * Copyright (c) 2020 Anthony Matarazzo.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+/**
+@author Anthony Matarazzo
+@file resize.h
+@date 11/3/20
+@version 1.0
+@details live resize. Dragging a window edge delivers a listen_resize_t for
+nearly every pixel. Rather than a text relayout and full render for each,
+frames between relayouts show the last rendered frame stretched to the new
+size. Relayout runs at most once per RESIZE_RELAYOUT_MS while the drag
+continues, and once more at the final size when it stops. Text layouts are
+cached by wrap width, so a layout whose width did not change, a height only
+resize or a text block of fixed width, is reused rather than rebuilt.
+*/
+
+namespace uxdevice {
+
+/**
+ * @internal
+ * @enum resize_action_t
+ * @brief what the render loop does for the next frame. stretch paints the
+ * previous frame through stretch_matrix(). repaint paints the previous frame
+ * unscaled, the size is back to the one it was laid out at and a stretched
+ * frame is showing. relayout lays out and renders at the current size.
+ */
+enum class resize_action_t { none, stretch, repaint, relayout };
+
+/**
+ * @internal
+ * @class resize_scheduler_t
+ * @brief fed by the resize events, queried once per frame.
+ */
+class resize_scheduler_t {
+public:
+  typedef std::chrono::steady_clock clock_t;
+
+  resize_scheduler_t(
+      std::chrono::milliseconds _interval =
+          std::chrono::milliseconds(RESIZE_RELAYOUT_MS),
+      std::chrono::milliseconds _settle =
+          std::chrono::milliseconds(RESIZE_SETTLE_MS))
+      : interval(_interval), settle(_settle) {}
+
+  void resized(int w, int h, clock_t::time_point now = clock_t::now()) {
+    width = w;
+    height = h;
+    last_event = now;
+    pending = w != laid_out_width || h != laid_out_height || stretched;
+  }
+
+  resize_action_t frame(clock_t::time_point now = clock_t::now()) {
+    if (!pending)
+      return resize_action_t::none;
+
+    if (width == laid_out_width && height == laid_out_height) {
+      pending = false;
+      stretched = false;
+      return resize_action_t::repaint;
+    }
+
+    if (now - last_event < settle && now - last_relayout < interval) {
+      stretched = true;
+      return resize_action_t::stretch;
+    }
+
+    last_relayout = now;
+    laid_out_width = width;
+    laid_out_height = height;
+    pending = false;
+    stretched = false;
+    return resize_action_t::relayout;
+  }
+
+  /**
+   * @fn stretch_matrix
+   * @brief scales the previous frame, rendered at the laid out size, to the
+   * current size.
+   */
+  matrix_t stretch_matrix(void) const {
+    matrix_t m = {};
+    if (laid_out_width > 0 && laid_out_height > 0)
+      m.init_scale(static_cast<double>(width) / laid_out_width,
+                   static_cast<double>(height) / laid_out_height);
+    return m;
+  }
+
+  /// @brief set when the first frame is rendered.
+  void rendered(int w, int h) {
+    laid_out_width = w;
+    laid_out_height = h;
+    stretched = false;
+  }
+
+  int width = {};
+  int height = {};
+  int laid_out_width = {};
+  int laid_out_height = {};
+
+private:
+  std::chrono::milliseconds interval = {};
+  std::chrono::milliseconds settle = {};
+  clock_t::time_point last_event = {};
+  clock_t::time_point last_relayout = {};
+  bool pending = false;
+
+  /// @brief a stretched frame was shown since the last layout.
+  bool stretched = false;
+};
+
+/**
+ * @internal
+ * @struct text_layout_key_t
+ * @brief a pango layout depends on the text, the values of the text units
+ * that shape it (font, alignment, indent, line space, tab stops, ellipsize)
+ * and the wrap width. The height matters only when the text is ellipsized
+ * and is zero otherwise. The hashes only select the entry, the cache
+ * confirms the text by text_identity_t and compares the style on a hit.
+ */
+struct text_layout_key_t {
+  std::size_t text_hash = {};
+  std::size_t style_hash = {};
+  int wrap_width = {};
+  int height = {};
+
+  bool operator==(const text_layout_key_t &o) const {
+    return text_hash == o.text_hash && style_hash == o.style_hash &&
+           wrap_width == o.wrap_width && height == o.height;
+  }
+
+  std::size_t hash_code(void) const noexcept {
+    std::size_t __value = {};
+    hash_combine(__value, text_hash, style_hash, wrap_width, height);
+    return __value;
+  }
+};
+
+} // namespace uxdevice
+
+template <> struct std::hash<uxdevice::text_layout_key_t> {
+  std::size_t
+  operator()(const uxdevice::text_layout_key_t &k) const noexcept {
+    return k.hash_code();
+  }
+};
+
+namespace uxdevice {
+
+/**
+ * @internal
+ * @struct text_identity_t
+ * @brief confirms the text of a cached layout without keeping a copy of it.
+ * id is the identity of the text unit within the display list. version
+ * increases each time the unit is changed, through operator[], get<T>() or
+ * notify_changed(). length is the byte length of the text, so a change that
+ * was not reported as one yet still misses when the length differs.
+ */
+struct text_identity_t {
+  std::size_t id = {};
+  std::uint64_t version = {};
+  std::size_t length = {};
+
+  bool operator==(const text_identity_t &o) const {
+    return id == o.id && version == o.version && length == o.length;
+  }
+};
+
+/**
+ * @internal
+ * @class text_layout_cache_t
+ * @tparam LAYOUT the layout, typically a wrapper that releases a
+ * PangoLayout when destroyed.
+ * @brief one per surface. During a resize the layouts at previous widths
+ * stay cached, so dragging the edge back reuses them as well.
+ */
+template <typename LAYOUT> class text_layout_cache_t {
+public:
+  typedef std::shared_ptr<LAYOUT> layout_t;
+
+  /// @brief the identity of the text and the style are kept with the
+  /// layout to confirm a hit.
+  struct entry_t {
+    text_identity_t text = {};
+    std::string style = {};
+    layout_t layout = {};
+  };
+
+  text_layout_cache_t(std::size_t _budget = TEXT_LAYOUT_CACHE_BUDGET)
+      : cache(_budget) {}
+
+  /**
+   * @fn acquire
+   * @brief style is a canonical description of the shaping units, such as
+   * the font description followed by the alignment, indent, line space, tab
+   * stops and ellipsize values, that key.style_hash was computed from.
+   * fn_create returns the layout and its approximate size in bytes. An entry
+   * whose text identity or style differs, a hash collision or a changed
+   * unit, is replaced. The hit costs no walk of the text.
+   */
+  template <typename FN>
+  layout_t acquire(const text_layout_key_t &key, const text_identity_t &text,
+                   const std::string &style, FN &&fn_create) {
+    if (auto e = cache.find(key))
+      if (e->text == text && e->style == style)
+        return e->layout;
+    auto created = fn_create();
+    if (created.first)
+      cache.insert(key,
+                   std::make_shared<entry_t>(
+                       entry_t{text, style, created.first}),
+                   created.second + style.size());
+    return created.first;
+  }
+
+  lru_cache_t<text_layout_key_t, entry_t> &layouts(void) { return cache; }
+
+private:
+  lru_cache_t<text_layout_key_t, entry_t> cache;
+};
+
+} // namespace uxdevice
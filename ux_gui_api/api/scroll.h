@@ -0,0 +1,145 @@
+/*
+ * This file is part of the ux_gui_stream distribution
+ * (https://github.com/amatarazzo777/ux_gui_stream).
+ * Copyright (c) 2020 Anthony Matarazzo.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+/**
+@author Anthony Matarazzo
+@file scroll.h
+@date 10/29/20
+@version 1.0
+@details the blit scroll path. When the only difference between two frames is
+a whole pixel translation of the content, from fn_translate or
+fn_device_offset, the existing framebuffer pixels are moved by the delta and
+only the newly exposed strips are added to the damage region. The caller
+then moves the damage tracker with damage_tracker_t::offset.
+*/
+
+namespace uxdevice {
+
+/**
+ * @internal
+ * @class scroll_detector_t
+ * @brief compares the content transform of consecutive frames. The caller
+ * supplies the matrix including the device offset, and reports the matrix
+ * of each unit drawn with drawn(). Moving pixels is only correct when every
+ * unit moved by the same delta, so a frame that drew a unit under any other
+ * matrix is followed by a full repaint.
+ */
+class scroll_detector_t {
+public:
+  /**
+   * @fn detect
+   * @brief returns true when the frame can be produced by moving pixels. dx
+   * and dy receive the whole pixel delta. The first frame, a change of scale
+   * or rotation, a fractional delta or a delta larger than the surface all
+   * require a full repaint. So does any other change: damage pending in the
+   * tracker, or a unit of the previous frame drawn under its own matrix.
+   */
+  bool detect(const matrix_t &m, const bounds_t &surface,
+              const damage_tracker_t &damage, int &dx, int &dy) {
+    bool ret = false;
+    const cairo_matrix_t &a = previous._matrix, &b = m._matrix;
+
+    if (valid && uniform && damage.region.empty() && !damage.measuring() &&
+        a.xx == b.xx && a.yx == b.yx && a.xy == b.xy && a.yy == b.yy) {
+      double fx = b.x0 - a.x0, fy = b.y0 - a.y0;
+      if (fx == std::floor(fx) && fy == std::floor(fy) &&
+          std::abs(fx) < surface.w && std::abs(fy) < surface.h &&
+          (fx != 0 || fy != 0)) {
+        dx = static_cast<int>(fx);
+        dy = static_cast<int>(fy);
+        ret = true;
+      }
+    }
+
+    previous = m;
+    valid = true;
+    uniform = true;
+    return ret;
+  }
+
+  /// @brief the matrix a unit of this frame was drawn under.
+  void drawn(const matrix_t &unit) {
+    const cairo_matrix_t &a = previous._matrix, &b = unit._matrix;
+    if (a.xx != b.xx || a.yx != b.yx || a.xy != b.xy || a.yy != b.yy ||
+        a.x0 != b.x0 || a.y0 != b.y0)
+      uniform = false;
+  }
+
+  /// @brief forces the next frame to repaint, after a resize or expose.
+  void reset(void) { valid = false; }
+
+  /**
+   * @fn exposed
+   * @brief the strips uncovered by moving the content by dx, dy. These are
+   * the only areas that must be rendered.
+   */
+  static void exposed(const bounds_t &surface, int dx, int dy,
+                      damage_region_t &damage) {
+    if (dx > 0)
+      damage.add({surface.x, surface.y, static_cast<double>(dx), surface.h});
+    else if (dx < 0)
+      damage.add({surface.right() + dx, surface.y, static_cast<double>(-dx),
+                  surface.h});
+
+    if (dy > 0)
+      damage.add({surface.x, surface.y, surface.w, static_cast<double>(dy)});
+    else if (dy < 0)
+      damage.add({surface.x, surface.bottom() + dy, surface.w,
+                  static_cast<double>(-dy)});
+  }
+
+private:
+  matrix_t previous = {};
+  bool valid = false;
+  bool uniform = false;
+};
+
+/**
+ * @internal
+ * @fn scroll_pixels
+ * @brief moves the content of a 32 bit framebuffer by dx, dy in place. Rows
+ * are copied in the order that does not overwrite rows not yet moved. The
+ * exposed strips keep their old pixels and must be rendered.
+ */
+inline void scroll_pixels(std::uint32_t *pixels, int width, int height,
+                          int stride, int dx, int dy) {
+  int w = width - std::abs(dx);
+  int h = height - std::abs(dy);
+  if (w <= 0 || h <= 0)
+    return;
+
+  int src_x = dx < 0 ? -dx : 0, dst_x = dx > 0 ? dx : 0;
+  int src_y = dy < 0 ? -dy : 0, dst_y = dy > 0 ? dy : 0;
+
+  auto row = [&](int y) {
+    std::memmove(
+        pixels + static_cast<std::size_t>(dst_y + y) * stride + dst_x,
+        pixels + static_cast<std::size_t>(src_y + y) * stride + src_x,
+        static_cast<std::size_t>(w) * sizeof(std::uint32_t));
+  };
+
+  if (dy > 0)
+    for (int y = h - 1; y >= 0; y--)
+      row(y);
+  else
+    for (int y = 0; y < h; y++)
+      row(y);
+}
+
+} // namespace uxdevice
@@ -0,0 +1,175 @@
+/*
+ * This file is part of the ux_gui_stream distribution
+ * (https://github.com/amatarazzo777/ux_gui_stream).
+ * Copyright (c) 2020 Anthony Matarazzo.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+/**
+@author Anthony Matarazzo
+@file stroke_cache.h
+@date 10/31/20
+@version 1.0
+@details stroke results reused across frames. Stroking the same path with the
+same line_width_t, line_join_t, line_cap_t, line_dashes_t, miter_limit_t
+and tollerance_t every frame produces the same outline. The outline is kept
+in user space, so any change of transform reuses it and only its fill is
+repeated. A coverage mask is kept in device space and is reused only when the
+matrix differs by a whole pixel translation.
+*/
+
+namespace uxdevice {
+
+/**
+ * @internal
+ * @struct stroke_state_t
+ * @brief the context values that determine the stroked outline. tolerance
+ * is included because it sets how finely curves and round joins are
+ * flattened.
+ */
+struct stroke_state_t {
+  double line_width = 2.0;
+  line_join_options_t join = line_join_options_t::miter;
+  line_cap_options_t cap = line_cap_options_t::butt;
+  double miter_limit = 10.0;
+  std::vector<double> dashes = {};
+  double dash_offset = {};
+  double tolerance = 0.1;
+
+  bool operator==(const stroke_state_t &o) const {
+    return line_width == o.line_width && join == o.join && cap == o.cap &&
+           miter_limit == o.miter_limit && dashes == o.dashes &&
+           dash_offset == o.dash_offset && tolerance == o.tolerance;
+  }
+
+  std::size_t hash_code(void) const noexcept {
+    std::size_t __value = {};
+    hash_combine(__value, line_width, static_cast<int>(join),
+                 static_cast<int>(cap), miter_limit, dash_offset, tolerance);
+    for (auto d : dashes)
+      hash_combine(__value, d);
+    return __value;
+  }
+};
+
+/**
+ * @internal
+ * @struct stroke_key_t
+ * @brief outlines are keyed by path, stroke state and scale bucket, the
+ * bucket because the curve flattening tolerance is in device units. Masks
+ * are additionally keyed by the linear part of the matrix and the sub pixel
+ * part of the translation. The path and state are compared on a hit, their
+ * hashes only select the bucket. A key made for a lookup points at the
+ * caller's path and state without copying them. The cache stores owned()
+ * copies.
+ */
+struct stroke_key_t {
+  std::shared_ptr<const packed_path_storage_t> path = {};
+  std::shared_ptr<const stroke_state_t> state = {};
+  std::size_t state_hash = {};
+  int bucket = {};
+  std::size_t transform_hash = {};
+
+  bool operator==(const stroke_key_t &o) const {
+    return state_hash == o.state_hash && bucket == o.bucket &&
+           transform_hash == o.transform_hash && *state == *o.state &&
+           *path == *o.path;
+  }
+
+  static stroke_key_t outline(const packed_path_storage_t &path,
+                              const stroke_state_t &state,
+                              const matrix_t &m) {
+    return {borrow(path), borrow(state), state.hash_code(),
+            uxdevice::scale_bucket(m), 0};
+  }
+
+  static stroke_key_t mask(const packed_path_storage_t &path,
+                           const stroke_state_t &state, const matrix_t &m) {
+    const cairo_matrix_t &c = m._matrix;
+    std::size_t t = {};
+    hash_combine(t, c.xx, c.yx, c.xy, c.yy, c.x0 - std::floor(c.x0),
+                 c.y0 - std::floor(c.y0));
+    return {borrow(path), borrow(state), state.hash_code(),
+            uxdevice::scale_bucket(m), t};
+  }
+
+  /// @brief the key with its own copies of the path and state, to be kept
+  /// after the caller's are gone.
+  stroke_key_t owned(void) const {
+    return {std::make_shared<const packed_path_storage_t>(*path),
+            std::make_shared<const stroke_state_t>(*state), state_hash, bucket,
+            transform_hash};
+  }
+
+  /// @brief a pointer that does not own, the aliasing constructor with an
+  /// empty owner allocates nothing.
+  template <typename T> static std::shared_ptr<const T> borrow(const T &v) {
+    return std::shared_ptr<const T>(std::shared_ptr<void>(), &v);
+  }
+
+  std::size_t hash_code(void) const noexcept {
+    std::size_t __value = {};
+    hash_combine(__value, path->hash_code(), state_hash, bucket,
+                 transform_hash);
+    return __value;
+  }
+};
+
+} // namespace uxdevice
+
+template <> struct std::hash<uxdevice::stroke_key_t> {
+  std::size_t operator()(const uxdevice::stroke_key_t &k) const noexcept {
+    return k.hash_code();
+  }
+};
+
+namespace uxdevice {
+
+/**
+ * @internal
+ * @class stroke_cache_t
+ * @tparam T the cached result. For outlines a cairo_path_t copy from
+ * cairo_stroke_to_path, for masks an A8 surface with its device origin.
+ * @brief a byte budgeted cache of one kind of result. The library keeps one
+ * for outlines and one for masks per surface.
+ */
+template <typename T> class stroke_cache_t {
+public:
+  typedef std::shared_ptr<T> result_t;
+
+  stroke_cache_t(std::size_t _budget) : cache(_budget) {}
+
+  /// @brief returns the cached result or creates and stores it. fn_create
+  /// returns the result and its size in bytes, the copy of the path kept in
+  /// the key is charged as well.
+  template <typename FN>
+  result_t acquire(const stroke_key_t &key, FN &&fn_create) {
+    if (auto r = cache.find(key))
+      return r;
+    auto created = fn_create();
+    if (created.first)
+      cache.insert(key.owned(), created.first,
+                   created.second + key.path->verbs.size() +
+                       2 * key.path->x.size() * sizeof(double));
+    return created.first;
+  }
+
+  lru_cache_t<stroke_key_t, T> &results(void) { return cache; }
+
+private:
+  lru_cache_t<stroke_key_t, T> cache;
+};
+
+} // namespace uxdevice
@@ -0,0 +1,582 @@
+/*
+ * This file is part of the ux_gui_stream distribution
+ * (https://github.com/amatarazzo777/ux_gui_stream).
+ * Copyright (c) 2020 Anthony Matarazzo.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+/**
+@author Anthony Matarazzo
+@file submission_lanes.h
+@date 11/6/20
+@version 1.0
+@details concurrent input to one surface. Every thread that inputs units has
+its own lane, a queue with a single producer and a single consumer, so
+producers never wait for each other or for the renderer. Each unit is
+stamped with a sequence number from a shared counter and the z order set by
+a z_order_t unit on that thread, and carries the matrix and save levels of
+that thread. At the frame boundary the render thread merges the lanes,
+ordering units by z and then by sequence, so the display list is the same
+whatever the scheduling of the producers, and applies each unit's transform
+as it goes. The units queued in all lanes are bounded by the capacity of the
+submission_policy_t. When they are full, its policy decides: block holds the
+producing thread until the render thread merges the lanes, drop_oldest
+discards the oldest queued drawing unit to make room, and fail_fast rejects
+the unit, which surface_area_t reports through system_error_t. Units that
+set state, such as a brush, a font or the matrix, are never dropped, as the
+drawing units after them depend on them. The depth, the time producers
+waited and the units dropped or rejected are reported in frame_statistics_t.
+Only producers that find the lanes full and the merge take its mutex. State
+the client keeps per surface, such as the transform stack, is kept per
+thread with per_thread_t, which releases it when the thread exits.
+*/
+
+namespace uxdevice {
+
+/**
+ * @internal
+ * @struct submission_statistics_t
+ * @brief counters since the previous call to statistics(), except depth
+ * which is the depth at the call.
+ */
+struct submission_statistics_t {
+  std::size_t depth = {};
+  std::size_t depth_max = {};
+  std::uint64_t waits = {};
+  double wait_ms = {};
+  double wait_max_ms = {};
+  std::uint64_t dropped = {};
+  std::uint64_t rejected = {};
+};
+
+/**
+ * @internal
+ * @class thread_token_t
+ * @brief identifies a thread for as long as it runs. Unlike std::thread::id,
+ * a token is never reused by a later thread. Owners of per thread state are
+ * called back when the thread exits so that they can release it.
+ */
+class thread_token_t {
+public:
+  typedef std::function<void(std::uint64_t)> exit_fn_t;
+
+  thread_token_t() : value(next()) {}
+
+  ~thread_token_t() {
+    for (auto &e : exits)
+      e.second(value);
+  }
+
+  thread_token_t(const thread_token_t &other) = delete;
+  thread_token_t &operator=(const thread_token_t &other) = delete;
+
+  /// @brief the calling thread's token.
+  static thread_token_t &local(void) {
+    thread_local thread_token_t token = {};
+    return token;
+  }
+
+  std::uint64_t id(void) const { return value; }
+
+  /// @brief fn(id) is called when the thread exits. owner is the object fn
+  /// refers to, the callbacks of destroyed owners are discarded as others
+  /// are added.
+  void at_exit(std::weak_ptr<void> owner, exit_fn_t fn) {
+    exits.erase(std::remove_if(exits.begin(), exits.end(),
+                               [](auto &e) { return e.first.expired(); }),
+                exits.end());
+    exits.emplace_back(std::move(owner), std::move(fn));
+  }
+
+private:
+  static std::uint64_t next(void) {
+    static std::atomic<std::uint64_t> ids = 1;
+    return ids.fetch_add(1);
+  }
+
+  std::uint64_t value = {};
+  std::vector<std::pair<std::weak_ptr<void>, exit_fn_t>> exits = {};
+};
+
+/**
+ * @internal
+ * @class per_thread_t
+ * @tparam T the state of one thread.
+ * @brief one T per thread for an owning object, keyed by thread_token_t.
+ * Lookup is a search of a small thread local cache, the registry mutex is
+ * taken only the first time a thread uses the object. The T of a thread is
+ * destroyed when the thread exits, unless fn_retain(T &) returns true, as
+ * for a lane still holding units. Such a T is still visited by for_each()
+ * and is destroyed by the first prune() at which fn_retain returns false.
+ */
+template <typename T> class per_thread_t {
+public:
+  typedef std::function<bool(T &)> retain_fn_t;
+
+  per_thread_t(retain_fn_t fn_retain = {})
+      : id(next_id()), registry(std::make_shared<registry_t>()) {
+    registry->fn_retain = std::move(fn_retain);
+  }
+
+  per_thread_t(const per_thread_t &other) = delete;
+  per_thread_t &operator=(const per_thread_t &other) = delete;
+
+  /// @brief the calling thread's T, created on first use.
+  T &local(void) const {
+    for (auto &c : cache)
+      if (c.id == id)
+        return *c.ptr;
+
+    thread_token_t &token = thread_token_t::local();
+    T *ptr = {};
+    bool created = false;
+    {
+      std::lock_guard<std::mutex> guard(registry->lock);
+      auto &p = registry->live[token.id()];
+      if (!p) {
+        p = std::make_unique<T>();
+        created = true;
+      }
+      ptr = p.get();
+    }
+    if (created) {
+      std::weak_ptr<registry_t> r = registry;
+      token.at_exit(r, [r, owner_id = id](std::uint64_t t) {
+        for (auto &c : cache)
+          if (c.id == owner_id)
+            c = {};
+        if (auto owner = r.lock())
+          owner->release(t);
+      });
+    }
+    cache[victim++ % cache.size()] = {id, ptr};
+    return *ptr;
+  }
+
+  /// @brief visits every thread's T, with registration and thread exit
+  /// locked out.
+  template <typename FN> void for_each(FN &&fn) const {
+    std::lock_guard<std::mutex> guard(registry->lock);
+    for (auto &n : registry->live)
+      fn(*n.second);
+    for (auto &t : registry->exited)
+      fn(*t);
+  }
+
+  /// @brief destroys the T of exited threads that are no longer retained.
+  void prune(void) {
+    std::vector<std::unique_ptr<T>> released = {};
+    {
+      std::lock_guard<std::mutex> guard(registry->lock);
+      auto &e = registry->exited;
+      auto it = std::partition(e.begin(), e.end(), [&](auto &t) {
+        return registry->fn_retain(*t);
+      });
+      std::move(it, e.end(), std::back_inserter(released));
+      e.erase(it, e.end());
+    }
+  }
+
+private:
+  /// @brief shared with the exit callbacks of the threads, which may run
+  /// after the owner is destroyed.
+  struct registry_t {
+    void release(std::uint64_t token) {
+      std::unique_ptr<T> t = {};
+      std::lock_guard<std::mutex> guard(lock);
+      auto n = live.find(token);
+      if (n == live.end())
+        return;
+      t = std::move(n->second);
+      live.erase(n);
+      if (fn_retain && fn_retain(*t))
+        exited.push_back(std::move(t));
+    }
+
+    std::mutex lock = {};
+    std::unordered_map<std::uint64_t, std::unique_ptr<T>> live = {};
+    std::vector<std::unique_ptr<T>> exited = {};
+    retain_fn_t fn_retain = {};
+  };
+
+  /// @brief ids are never reused, so a cache entry of a destroyed owner
+  /// never matches a new owner allocated at the same address.
+  static std::uint64_t next_id(void) {
+    static std::atomic<std::uint64_t> ids = 1;
+    return ids.fetch_add(1);
+  }
+
+  struct cache_entry_t {
+    std::uint64_t id = {};
+    T *ptr = {};
+  };
+
+  static thread_local std::array<cache_entry_t, 4> cache;
+  static thread_local std::size_t victim;
+
+  std::uint64_t id = {};
+  std::shared_ptr<registry_t> registry = {};
+};
+
+template <typename T>
+thread_local std::array<typename per_thread_t<T>::cache_entry_t, 4>
+    per_thread_t<T>::cache = {};
+
+template <typename T> thread_local std::size_t per_thread_t<T>::victim = {};
+
+/**
+ * @internal
+ * @class submission_lanes_t
+ * @tparam T the library copy of an input unit.
+ * @brief push() from any thread, merge() from the render thread. close()
+ * releases blocked producers when the surface is destroyed, their units are
+ * rejected.
+ */
+template <typename T> class submission_lanes_t {
+public:
+  typedef std::chrono::steady_clock clock_t;
+
+  /// @brief lane identifies the producing thread, so the save levels of the
+  /// transform are compared with the previous entry of the same lane. state
+  /// marks a unit that sets drawing state, which drop_oldest keeps.
+  struct entry_t {
+    std::int64_t z = {};
+    std::uint64_t sequence = {};
+    std::uint64_t lane = {};
+    unit_transform_t transform = {};
+    bool state = false;
+    T value = {};
+  };
+
+  void set_policy(submission_policy_options_t _policy, std::size_t _capacity) {
+    std::lock_guard<std::mutex> guard(full);
+    policy.store(_policy, std::memory_order_relaxed);
+    capacity.store(std::max<std::size_t>(_capacity, 1),
+                   std::memory_order_relaxed);
+    not_full.notify_all();
+  }
+
+  /**
+   * @fn push
+   * @brief appends to the calling thread's lane. While the lanes are below
+   * capacity the shared writes are the sequence counter and the count of
+   * queued units, both single atomic operations. At capacity the policy
+   * applies: block waits for a merge, drop_oldest discards the oldest queued
+   * drawing unit of any lane, or waits when every queued unit sets state,
+   * and fail_fast rejects the unit.
+   */
+  submit_result_t push(T &&v, bool state, const unit_transform_t &transform) {
+    submit_result_t ret = submit_result_t::queued;
+    if (closed.load(std::memory_order_relaxed) || !reserve()) {
+      ret = make_room();
+      if (ret == submit_result_t::rejected)
+        return ret;
+    }
+
+    lane_t &l = lanes.local();
+    if (!l.id)
+      l.id = lane_ids.fetch_add(1, std::memory_order_relaxed) + 1;
+    l.push({l.z, sequence.fetch_add(1, std::memory_order_relaxed), l.id,
+            transform, state, std::move(v)});
+    return ret;
+  }
+
+  /// @brief the z order of the units the calling thread pushes next.
+  void z_order(std::int64_t z) { lanes.local().z = z; }
+
+  /**
+   * @fn merge
+   * @brief moves the entries of every lane to out, ordered by z and then
+   * sequence. An entry pushed while the merge runs is either in this merge
+   * or the next, as the frame boundary falls between submissions. Each lane
+   * is already in sequence order, and in z order unless its thread changed
+   * z downward, so the lanes are merged as sorted runs rather than sorted
+   * as a whole. The consumer sets the matrix of each entry before drawing
+   * it, and undoes the state units of a lane input at levels deeper than
+   * unit_transform_t::shared() of an entry and the lane's entry before it.
+   */
+  std::size_t merge(std::vector<entry_t> &out) {
+    auto less = [](const entry_t &a, const entry_t &b) {
+      return a.z != b.z ? a.z < b.z : a.sequence < b.sequence;
+    };
+
+    std::size_t first = out.size();
+    {
+      std::lock_guard<std::mutex> guard(full);
+      stats.depth_max = std::max(stats.depth_max, size());
+      out.reserve(first + size());
+      runs.assign(1, first);
+      lanes.for_each([&](lane_t &l) {
+        l.pop_all(out);
+        if (out.size() != runs.back())
+          runs.push_back(out.size());
+      });
+      lanes.prune();
+      queued.fetch_sub(out.size() - first, std::memory_order_relaxed);
+      not_full.notify_all();
+    }
+
+    std::size_t count = runs.size() - 1;
+    for (std::size_t i = 0; i < count; i++)
+      if (!std::is_sorted(out.begin() + runs[i], out.begin() + runs[i + 1],
+                          less))
+        std::sort(out.begin() + runs[i], out.begin() + runs[i + 1], less);
+
+    for (std::size_t width = 1; width < count; width *= 2)
+      for (std::size_t i = 0; i + width < count; i += 2 * width)
+        std::inplace_merge(out.begin() + runs[i], out.begin() + runs[i + width],
+                           out.begin() + runs[std::min(i + 2 * width, count)],
+                           less);
+
+    return out.size() - first;
+  }
+
+  /// @brief units pushed and not yet merged, for the submission policy and
+  /// frame_statistics_t::queue_depth.
+  std::size_t size(void) const {
+    return queued.load(std::memory_order_relaxed);
+  }
+
+  void close(void) {
+    std::lock_guard<std::mutex> guard(full);
+    closed.store(true, std::memory_order_relaxed);
+    not_full.notify_all();
+  }
+
+  /// @brief the counters for frame_statistics_t, which are then reset. The
+  /// peak depth is sampled at each merge and when the lanes are full.
+  submission_statistics_t statistics(void) {
+    std::lock_guard<std::mutex> guard(full);
+    submission_statistics_t ret = stats;
+    ret.depth = size();
+    stats = {};
+    stats.depth_max = ret.depth;
+    return ret;
+  }
+
+private:
+  /**
+   * @internal
+   * @class lane_t
+   * @brief a list of fixed size blocks. The producer publishes an entry by
+   * storing the block count with release order, the consumer reads up to
+   * the count it loads with acquire order. A block is freed by the consumer
+   * once it is read and the producer has moved to the next. The consumer is
+   * whoever holds the mutex of the lanes, the merge or a producer dropping
+   * a unit, which marks it dropped and releases its value. A dropped entry
+   * is skipped by the merge.
+   */
+  class lane_t {
+    struct block_t {
+      std::array<entry_t, SUBMISSION_LANE_BLOCK> entries = {};
+      std::array<bool, SUBMISSION_LANE_BLOCK> dropped = {};
+      std::atomic<std::size_t> count = {};
+      std::atomic<block_t *> next = {};
+    };
+
+  public:
+    struct position_t {
+      block_t *block = {};
+      std::size_t index = {};
+    };
+
+    lane_t() : head(new block_t), tail(head) {}
+
+    ~lane_t() {
+      while (head) {
+        block_t *next = head->next.load();
+        delete head;
+        head = next;
+      }
+    }
+
+    void push(entry_t &&e) {
+      std::size_t c = tail->count.load(std::memory_order_relaxed);
+      if (c == SUBMISSION_LANE_BLOCK) {
+        block_t *b = new block_t;
+        tail->next.store(b, std::memory_order_release);
+        tail = b;
+        c = 0;
+      }
+      tail->entries[c] = std::move(e);
+      tail->count.store(c + 1, std::memory_order_release);
+    }
+
+    void pop_all(std::vector<entry_t> &out) {
+      do {
+        std::size_t c = head->count.load(std::memory_order_acquire);
+        for (; read < c; read++)
+          if (!head->dropped[read])
+            out.push_back(std::move(head->entries[read]));
+      } while (advance());
+    }
+
+    /// @brief nothing is left to read. A lane of an exited thread is kept
+    /// until it is empty.
+    bool empty(void) const {
+      return read == head->count.load(std::memory_order_acquire) &&
+             !head->next.load(std::memory_order_acquire);
+    }
+
+    /// @brief the oldest queued entry that does not set state, block is
+    /// nullptr when there is none.
+    position_t oldest_drawing(void) const {
+      std::size_t i = read;
+      for (block_t *b = head; b; b = b->next.load(std::memory_order_acquire)) {
+        std::size_t c = b->count.load(std::memory_order_acquire);
+        for (; i < c; i++)
+          if (!b->dropped[i] && !b->entries[i].state)
+            return {b, i};
+        if (c < SUBMISSION_LANE_BLOCK)
+          break;
+        i = 0;
+      }
+      return {};
+    }
+
+    /// @brief drops the entry at p. Dropped entries at the front of the
+    /// lane are passed, so their blocks are freed before the next merge.
+    void drop(position_t p) {
+      p.block->dropped[p.index] = true;
+      p.block->entries[p.index].value = {};
+      do {
+        std::size_t c = head->count.load(std::memory_order_acquire);
+        while (read < c && head->dropped[read])
+          read++;
+        if (read < c)
+          return;
+      } while (advance());
+    }
+
+    /// @brief written and read by the producing thread only.
+    std::int64_t z = {};
+    std::uint64_t id = {};
+
+  private:
+    /// @brief moves to the next block once the head is read and the
+    /// producer has moved on.
+    bool advance(void) {
+      if (read < SUBMISSION_LANE_BLOCK)
+        return false;
+      block_t *next = head->next.load(std::memory_order_acquire);
+      if (!next)
+        return false;
+      delete head;
+      head = next;
+      read = 0;
+      return true;
+    }
+
+    block_t *head = {};
+    std::size_t read = {};
+    alignas(64) block_t *tail = {};
+  };
+
+  /// @brief takes a place for one unit when the lanes are below capacity.
+  bool reserve(void) {
+    std::size_t n = queued.load(std::memory_order_relaxed);
+    std::size_t limit = capacity.load(std::memory_order_relaxed);
+    while (n < limit)
+      if (queued.compare_exchange_weak(n, n + 1, std::memory_order_relaxed))
+        return true;
+    return false;
+  }
+
+  /// @brief applies the policy when the lanes are full, and returns with a
+  /// place reserved unless the unit is rejected.
+  submit_result_t make_room(void) {
+    std::unique_lock<std::mutex> guard(full);
+    submit_result_t ret = submit_result_t::queued;
+    stats.depth_max = std::max(stats.depth_max, size());
+    bool waited = false;
+    auto start = clock_t::now();
+
+    for (;;) {
+      if (closed.load(std::memory_order_relaxed)) {
+        stats.rejected++;
+        return submit_result_t::rejected;
+      }
+      if (reserve())
+        break;
+
+      auto p = policy.load(std::memory_order_relaxed);
+      if (p == submission_policy_options_t::fail_fast) {
+        stats.rejected++;
+        return submit_result_t::rejected;
+      }
+      if (p == submission_policy_options_t::drop_oldest && drop_oldest()) {
+        stats.dropped++;
+        ret = submit_result_t::dropped_oldest;
+        continue;
+      }
+      waited = true;
+      not_full.wait(guard);
+    }
+
+    if (waited) {
+      double ms =
+          std::chrono::duration<double, std::milli>(clock_t::now() - start)
+              .count();
+      stats.waits++;
+      stats.wait_ms += ms;
+      stats.wait_max_ms = std::max(stats.wait_max_ms, ms);
+    }
+    return ret;
+  }
+
+  /// @brief drops the queued drawing unit with the lowest sequence of all
+  /// lanes. Called with the mutex held.
+  bool drop_oldest(void) {
+    lane_t *lane = {};
+    typename lane_t::position_t oldest = {};
+    std::uint64_t first = UINT64_MAX;
+    lanes.for_each([&](lane_t &l) {
+      auto p = l.oldest_drawing();
+      if (p.block && p.block->entries[p.index].sequence < first) {
+        first = p.block->entries[p.index].sequence;
+        lane = &l;
+        oldest = p;
+      }
+    });
+    if (!lane)
+      return false;
+
+    // dropped with the registry locked, as the exit of the lane's thread
+    // tests whether the lane is empty.
+    lanes.for_each([&](lane_t &l) {
+      if (&l == lane)
+        l.drop(oldest);
+    });
+    queued.fetch_sub(1, std::memory_order_relaxed);
+    return true;
+  }
+
+  alignas(64) std::atomic<std::uint64_t> sequence = {};
+  alignas(64) std::atomic<std::size_t> queued = {};
+  std::atomic<std::size_t> capacity = SUBMISSION_QUEUE_CAPACITY;
+  std::atomic<submission_policy_options_t> policy =
+      submission_policy_options_t::block;
+  std::atomic<std::uint64_t> lane_ids = {};
+  per_thread_t<lane_t> lanes{[](lane_t &l) { return !l.empty(); }};
+  std::vector<std::size_t> runs = {};
+
+  /// @brief taken by the merge and by producers that find the lanes full.
+  std::mutex full = {};
+  std::condition_variable not_full = {};
+  submission_statistics_t stats = {};
+  std::atomic<bool> closed = false;
+};
+
+} // namespace uxdevice
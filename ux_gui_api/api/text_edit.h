@@ -0,0 +1,153 @@
+/*
+ * This file is part of the ux_gui_stream distribution
+ * (https://github.com/amatarazzo777/ux_gui_stream).
+ * Copyright (c) 2020 Anthony Matarazzo.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+/**
+@author Anthony Matarazzo
+@file text_edit.h
+@date 11/5/20
+@version 1.0
+@details incremental relayout of edited text. A client that edits a shared
+std::string in place reports the changed bytes with
+surface_area_t::notify_changed() rather than resubmitting it. The text is
+laid out one paragraph at a time, a paragraph ending at a newline as in pango,
+so an edit reshapes only the paragraphs it touches. The paragraphs after it
+keep their layouts and have their offsets moved by the change in length.
+*/
+
+namespace uxdevice {
+
+/**
+ * @struct text_edit_t
+ * @brief removed bytes at offset were replaced by inserted bytes. An append
+ * is an edit at the old end of the text that removes nothing.
+ */
+struct text_edit_t {
+  std::size_t offset = {};
+  std::size_t removed = {};
+  std::size_t inserted = {};
+};
+
+/**
+ * @internal
+ * @class paragraph_layouts_t
+ * @tparam LAYOUT one laid out paragraph, typically a PangoLayout wrapper.
+ * @brief the layouts of a text by paragraph, in text order.
+ */
+template <typename LAYOUT> class paragraph_layouts_t {
+public:
+  typedef std::shared_ptr<LAYOUT> layout_t;
+
+  struct paragraph_t {
+    std::size_t offset = {};
+    std::size_t length = {};
+    layout_t layout = {};
+  };
+
+  /**
+   * @fn build
+   * @brief lays out the whole text. fn_create(std::string_view) lays out one
+   * paragraph, without its newline. Returns the number of paragraphs.
+   */
+  template <typename FN>
+  std::size_t build(const char *data, std::size_t size, FN &&fn_create) {
+    paragraphs.clear();
+    return split(data, 0, size, fn_create, paragraphs.end());
+  }
+
+  /**
+   * @fn apply
+   * @brief data and size are the text after the edit. The paragraphs from
+   * the one containing the edit offset to the one containing the end of the
+   * removed bytes are laid out again from the edited text, so a newline
+   * removed joins two and one inserted splits one. The paragraphs before are
+   * kept and those after are kept and moved. An edit that does not fit the
+   * text, its range past the end of the text before the edit or its change
+   * in length not that of size, lays out the whole text again. Returns the
+   * number of paragraphs laid out.
+   */
+  template <typename FN>
+  std::size_t apply(const char *data, std::size_t size, const text_edit_t &e,
+                    FN &&fn_create) {
+    if (paragraphs.empty() || !fits(size, e))
+      return build(data, size, fn_create);
+
+    auto first = containing(e.offset);
+    auto last = containing(e.offset + e.removed);
+    std::size_t begin = first->offset;
+    std::size_t end = last->offset + last->length + e.inserted - e.removed;
+
+    auto tail = paragraphs.erase(first, std::next(last));
+    for (auto it = tail; it != paragraphs.end(); ++it)
+      it->offset = it->offset + e.inserted - e.removed;
+
+    return split(data, begin, std::min(end, size), fn_create, tail);
+  }
+
+  std::size_t size(void) const { return paragraphs.size(); }
+  const paragraph_t &operator[](std::size_t n) const { return paragraphs[n]; }
+
+  void clear(void) { paragraphs.clear(); }
+
+private:
+  typedef typename std::vector<paragraph_t>::iterator iterator_t;
+
+  /// @brief the edit lies within the text laid out and turns its length
+  /// into size.
+  bool fits(std::size_t size, const text_edit_t &e) const {
+    const paragraph_t &back = paragraphs.back();
+    std::size_t old_size = back.offset + back.length;
+    return e.offset <= old_size && e.removed <= old_size - e.offset &&
+           e.inserted <= size && size - e.inserted == old_size - e.removed;
+  }
+
+  /// @brief the paragraph whose text or terminating newline is at offset.
+  iterator_t containing(std::size_t offset) {
+    auto it = std::upper_bound(
+        paragraphs.begin(), paragraphs.end(), offset,
+        [](std::size_t o, const paragraph_t &p) { return o < p.offset; });
+    return std::prev(it);
+  }
+
+  /// @brief lays out the paragraphs of data[begin, end) and inserts them
+  /// before pos. end is at a newline or the end of the text, so the last
+  /// paragraph is the text after the last newline, possibly empty.
+  template <typename FN>
+  std::size_t split(const char *data, std::size_t begin, std::size_t end,
+                    FN &fn_create, iterator_t pos) {
+    std::vector<paragraph_t> created = {};
+    std::size_t offset = begin;
+    for (;;) {
+      auto nl = static_cast<const char *>(
+          std::memchr(data + offset, '\n', end - offset));
+      std::size_t stop = nl ? static_cast<std::size_t>(nl - data) : end;
+      created.push_back({offset, stop - offset,
+                         fn_create(std::string_view(data + offset,
+                                                    stop - offset))});
+      if (!nl)
+        break;
+      offset = stop + 1;
+    }
+    paragraphs.insert(pos, created.begin(), created.end());
+    return created.size();
+  }
+
+  std::vector<paragraph_t> paragraphs = {};
+};
+
+} // namespace uxdevice
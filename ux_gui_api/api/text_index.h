@@ -0,0 +1,243 @@
+/*
+ * This file is part of the ux_gui_stream distribution
+ * (https://github.com/amatarazzo777/ux_gui_stream).
+ * Copyright (c) 2020 Anthony Matarazzo.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+/**
+@author Anthony Matarazzo
+@file text_index.h
+@date 11/4/20
+@version 1.0
+@details virtualized text. With text_layout_options_t::virtualized a text
+unit is not laid out as a whole. A line index records where lines begin and
+only the lines intersecting the viewport, plus TEXT_OVERSCAN_LINES above and
+below, are laid out, one layout per line. Lines are of uniform height and are
+not wrapped, as in log and source views, so the line at any scroll position
+is found by division. The index keeps one offset per TEXT_INDEX_STRIDE lines,
+so its memory is a small fraction of the line count and the laid out window
+is bounded by the viewport, whatever the document size.
+*/
+
+namespace uxdevice {
+
+/**
+ * @internal
+ * @class line_index_t
+ * @brief the index does not own the text. Every call receives the same
+ * buffer, which may grow between calls, as a mapped file being appended to
+ * does. append() scans only the bytes added since the previous call, so the
+ * index can be built incrementally while the first lines are already shown.
+ */
+class line_index_t {
+public:
+  line_index_t(std::size_t _stride = TEXT_INDEX_STRIDE) : stride(_stride) {}
+
+  void clear(void) {
+    checkpoints.assign(1, 0);
+    lines = 1;
+    scanned = 0;
+  }
+
+  /**
+   * @fn append
+   * @brief indexes data[scanned(), min(size, scanned() + limit)). Returns
+   * the number of bytes scanned, which is less than the remainder when a
+   * limit is given, for indexing in slices between frames.
+   */
+  std::size_t append(const char *data, std::size_t size,
+                     std::size_t limit = SIZE_MAX) {
+    if (size <= scanned)
+      return 0;
+    std::size_t end = size - scanned > limit ? scanned + limit : size;
+    std::size_t begin = scanned;
+    const char *p = data + scanned;
+    const char *e = data + end;
+    while (p < e) {
+      auto nl = static_cast<const char *>(std::memchr(p, '\n', e - p));
+      if (!nl)
+        break;
+      p = nl + 1;
+      if (lines % stride == 0)
+        checkpoints.push_back(static_cast<std::uint64_t>(p - data));
+      lines++;
+    }
+    scanned = end;
+    return end - begin;
+  }
+
+  /**
+   * @fn invalidate_from
+   * @brief after an edit at offset, drops what was indexed from the last
+   * checkpoint at or before it. The next append() scans again from there,
+   * so an edit near the end of a large text rescans a few lines only.
+   */
+  void invalidate_from(std::size_t offset) {
+    if (offset >= scanned)
+      return;
+    auto it = std::upper_bound(checkpoints.begin(), checkpoints.end(),
+                               static_cast<std::uint64_t>(offset));
+    std::size_t k = static_cast<std::size_t>(it - checkpoints.begin()) - 1;
+    checkpoints.resize(k + 1);
+    lines = k * stride + 1;
+    scanned = checkpoints[k];
+  }
+
+  /// @brief lines found so far. A final line without a newline is counted.
+  std::size_t size(void) const { return lines; }
+
+  std::size_t bytes_scanned(void) const { return scanned; }
+
+  /**
+   * @fn line_start
+   * @brief the offset of line n. At most stride - 1 newlines are searched
+   * from the preceding checkpoint.
+   */
+  std::size_t line_start(const char *data, std::size_t n) const {
+    n = std::min(n, lines - 1);
+    std::size_t offset = checkpoints[n / stride];
+    for (std::size_t k = n % stride; k > 0; k--) {
+      auto nl = static_cast<const char *>(
+          std::memchr(data + offset, '\n', scanned - offset));
+      offset = static_cast<std::size_t>(nl - data) + 1;
+    }
+    return offset;
+  }
+
+  /**
+   * @fn lines_in
+   * @brief the text of count lines from first, without their newlines.
+   * Consecutive lines are found with one search each after the first.
+   */
+  std::vector<std::string_view> lines_in(const char *data, std::size_t first,
+                                         std::size_t count) const {
+    std::vector<std::string_view> ret = {};
+    if (first >= lines)
+      return ret;
+    count = std::min(count, lines - first);
+    ret.reserve(count);
+    std::size_t offset = line_start(data, first);
+    for (std::size_t i = 0; i < count; i++) {
+      auto nl = static_cast<const char *>(
+          std::memchr(data + offset, '\n', scanned - offset));
+      std::size_t end = nl ? static_cast<std::size_t>(nl - data) : scanned;
+      ret.emplace_back(data + offset, end - offset);
+      offset = end + 1;
+    }
+    return ret;
+  }
+
+  /// @brief memory held by the index.
+  std::size_t bytes(void) const {
+    return checkpoints.capacity() * sizeof(std::uint64_t);
+  }
+
+private:
+  std::size_t stride = {};
+  std::vector<std::uint64_t> checkpoints = {0};
+  std::size_t lines = 1;
+  std::size_t scanned = {};
+};
+
+/**
+ * @internal
+ * @struct line_window_t
+ * @brief the lines to lay out for a viewport, first and count.
+ */
+struct line_window_t {
+  std::size_t first = {};
+  std::size_t count = {};
+
+  bool contains(std::size_t line) const {
+    return line >= first && line < first + count;
+  }
+};
+
+/**
+ * @internal
+ * @fn visible_lines
+ * @brief the window for a viewport of height pixels scrolled to scroll_y,
+ * extended by overscan lines on each side and clamped to the document.
+ */
+inline line_window_t
+visible_lines(double scroll_y, double height, double line_height,
+              std::size_t lines, std::size_t overscan = TEXT_OVERSCAN_LINES) {
+  if (line_height <= 0 || lines == 0)
+    return {};
+  double top = std::max(0.0, scroll_y);
+  std::size_t first = static_cast<std::size_t>(top / line_height);
+  std::size_t last =
+      static_cast<std::size_t>(std::ceil((top + height) / line_height));
+  first = first > overscan ? first - overscan : 0;
+  last = std::min(lines, last + overscan);
+  if (first >= last)
+    return {std::min(first, lines), 0};
+  return {first, last - first};
+}
+
+/**
+ * @internal
+ * @class line_layouts_t
+ * @tparam LAYOUT one laid out line, typically a PangoLayout wrapper.
+ * @brief the layouts of the current window. update() keeps the layouts of
+ * lines that remain in the window, so scrolling by a few lines lays out only
+ * the lines that enter, and releases the rest.
+ */
+template <typename LAYOUT> class line_layouts_t {
+public:
+  typedef std::shared_ptr<LAYOUT> layout_t;
+
+  /**
+   * @fn update
+   * @brief fn_create(line number) lays out one line. Returns the number of
+   * lines laid out.
+   */
+  template <typename FN>
+  std::size_t update(const line_window_t &w, FN &&fn_create) {
+    std::vector<layout_t> next(w.count);
+    std::size_t created = {};
+    for (std::size_t i = 0; i < w.count; i++) {
+      std::size_t line = w.first + i;
+      if (window.contains(line) && layouts[line - window.first]) {
+        next[i] = std::move(layouts[line - window.first]);
+      } else {
+        next[i] = fn_create(line);
+        created++;
+      }
+    }
+    layouts = std::move(next);
+    window = w;
+    return created;
+  }
+
+  /// @brief the layout of a line within the window, nullptr otherwise.
+  layout_t line(std::size_t n) const {
+    return window.contains(n) ? layouts[n - window.first] : layout_t{};
+  }
+
+  const line_window_t &range(void) const { return window; }
+
+  void clear(void) {
+    layouts.clear();
+    window = {};
+  }
+
+private:
+  line_window_t window = {};
+  std::vector<layout_t> layouts = {};
+};
+
+} // namespace uxdevice
@@ -0,0 +1,150 @@
+/*
+ * This file is part of the ux_gui_stream distribution
+ * (https://github.com/amatarazzo777/ux_gui_stream).
+ * Copyright (c) 2020 Anthony Matarazzo.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+/**
+@author Anthony Matarazzo
+@file text_source.h
+@date 11/4/20
+@version 1.0
+@details text read from a memory mapped file. A text_file_t unit names a
+file, or a region of one, instead of carrying the text. The library maps it
+and reads only the pages the visible lines are on, so opening a large log
+costs neither a copy of the file nor a wait for it to be read. The line index
+is built a slice at a time between frames, and the first lines are shown as
+soon as the first slice is indexed.
+
+A followed file is not mapped. A writer may truncate it at any time, and
+reading a mapped page past the new end of file raises SIGBUS, which no check
+made before the read can rule out. Its text is read with pread into a buffer
+instead, appending what the file grew by.
+*/
+
+namespace uxdevice {
+
+/**
+ * @internal
+ * @class text_file_source_t
+ * @brief one per text_file_t unit in the display list. update() is called
+ * once per frame by the render thread.
+ */
+class text_file_source_t {
+public:
+  text_file_source_t() {}
+
+  /// @brief errors opening or mapping the file are thrown as runtime_error
+  /// by mapped_file_t.
+  void open(const std::string &filename, std::size_t offset = 0,
+            std::size_t length = 0, bool _follow = false) {
+    file.open(filename, offset, length, !_follow);
+    follow = _follow;
+    index.clear();
+    text.clear();
+  }
+
+  /**
+   * @fn update
+   * @brief follows growth of the file when follow is set and indexes up to
+   * limit more bytes. Returns true when the lines changed, so the frame must
+   * be rendered. A file that was truncated, or replaced by log rotation, is
+   * indexed again from the start. So is a followed file truncated and then
+   * written past its old size before this call, which its size alone shows
+   * as grown: the last bytes read are compared with the file.
+   */
+  bool update(std::size_t limit = TEXT_INDEX_SLICE) {
+    bool reset = false;
+    switch (file.refresh(follow)) {
+    case mapped_file_t::change_t::truncated:
+    case mapped_file_t::change_t::replaced:
+      reset = true;
+      break;
+    default:
+      reset = follow && rewritten();
+      break;
+    }
+    if (reset) {
+      index.clear();
+      text.clear();
+    }
+
+    if (follow && file.size() > text.size()) {
+      std::size_t have = text.size();
+      text.resize(file.size());
+      text.resize(have + file.read(have, &text[have], file.size() - have));
+    }
+
+    std::size_t lines = index.size();
+    index.append(region(), region_size(), limit);
+    return reset || index.size() != lines;
+  }
+
+  /// @brief true when the whole region has been indexed.
+  bool indexed(void) const {
+    return index.bytes_scanned() == region_size();
+  }
+
+  /**
+   * @fn lines_in
+   * @brief the text of the requested lines, as views into the mapping or
+   * the buffer of a followed file that are valid until the next update().
+   * Before a mapping is read, read ahead is requested for the pages from the
+   * first line, sized by the average line length indexed so far. Nothing is
+   * returned when a mapped file was truncated since the last update(), the
+   * next update() remaps it.
+   */
+  std::vector<std::string_view> lines_in(std::size_t first,
+                                         std::size_t count) const {
+    if (follow)
+      return index.lines_in(text.data(), first, count);
+    if (!file.data() || file.truncated())
+      return {};
+    std::size_t average = index.bytes_scanned() / index.size() + 1;
+    file.prefetch(index.line_start(file.data(), first), average * count);
+    return index.lines_in(file.data(), first, count);
+  }
+
+  std::size_t size(void) const { return index.size(); }
+  const mapped_file_t &mapping(void) const { return file; }
+
+private:
+  const char *region(void) const {
+    return follow ? text.data() : file.data();
+  }
+  std::size_t region_size(void) const {
+    return follow ? text.size() : file.size();
+  }
+
+  /// @brief true when the last bytes read of a followed file differ from
+  /// the file, so it was rewritten rather than appended to.
+  bool rewritten(void) const {
+    std::size_t n = std::min<std::size_t>(text.size(), 64);
+    if (!n)
+      return false;
+    char now[64];
+    std::size_t pos = text.size() - n;
+    return file.read(pos, now, n) != n ||
+           std::memcmp(now, text.data() + pos, n) != 0;
+  }
+
+  mapped_file_t file = {};
+  line_index_t index = {};
+  std::string text = {};
+  bool follow = false;
+};
+
+} // namespace uxdevice
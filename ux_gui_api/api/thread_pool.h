@@ -0,0 +1,107 @@
+/*
+ * This file is part of the ux_gui_stream distribution
+ * (https://github.com/amatarazzo777/ux_gui_stream).
+ * Copyright (c) 2020 Anthony Matarazzo.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+/**
+@author Anthony Matarazzo
+@file thread_pool.h
+@date 10/26/20
+@version 1.0
+@details worker threads used for work that must not run on the thread that
+processes the display units, such as image decoding.
+*/
+
+namespace uxdevice {
+
+/**
+ * @internal
+ * @class thread_pool_t
+ * @brief a fixed number of workers servicing a fifo of tasks. The destructor
+ * finishes the queued tasks before joining.
+ */
+class thread_pool_t {
+public:
+  /// @brief zero threads uses std::thread::hardware_concurrency(), or one
+  /// thread when that is unknown.
+  thread_pool_t(std::size_t _threads = 0) {
+    if (_threads == 0)
+      _threads = std::thread::hardware_concurrency();
+    if (_threads == 0)
+      _threads = 1;
+    for (std::size_t i = 0; i < _threads; i++)
+      workers.emplace_back([this]() { worker(); });
+  }
+
+  ~thread_pool_t() {
+    {
+      std::lock_guard<std::mutex> guard(lock);
+      bterminate = true;
+    }
+    cv.notify_all();
+    for (auto &t : workers)
+      t.join();
+  }
+
+  thread_pool_t(const thread_pool_t &other) = delete;
+  thread_pool_t &operator=(const thread_pool_t &other) = delete;
+
+  /**
+   * @fn submit
+   * @brief queues the callable. The returned future holds the result or the
+   * exception thrown by the task.
+   */
+  template <typename FN>
+  auto submit(FN &&fn) -> std::future<decltype(fn())> {
+    using result_t = decltype(fn());
+    auto task =
+        std::make_shared<std::packaged_task<result_t()>>(std::forward<FN>(fn));
+    std::future<result_t> ret = task->get_future();
+    {
+      std::lock_guard<std::mutex> guard(lock);
+      tasks.emplace_back([task]() { (*task)(); });
+    }
+    cv.notify_one();
+    return ret;
+  }
+
+  std::size_t size(void) const { return workers.size(); }
+
+private:
+  void worker(void) {
+    while (true) {
+      std::function<void()> task = {};
+      {
+        std::unique_lock<std::mutex> guard(lock);
+        cv.wait(guard, [this]() { return bterminate || !tasks.empty(); });
+        if (tasks.empty())
+          return;
+        task = std::move(tasks.front());
+        tasks.pop_front();
+      }
+      task();
+    }
+  }
+
+  std::vector<std::thread> workers = {};
+  std::deque<std::function<void()>> tasks = {};
+  std::mutex lock = {};
+  std::condition_variable cv = {};
+  bool bterminate = false;
+};
+
+} // namespace uxdevice
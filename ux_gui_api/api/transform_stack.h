@@ -0,0 +1,155 @@
+/*
+ * This file is part of the ux_gui_stream distribution
+ * (https://github.com/amatarazzo777/ux_gui_stream).
+ * Copyright (c) 2020 Anthony Matarazzo.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+/**
+@author Anthony Matarazzo
+@file transform_stack.h
+@date 11/1/20
+@version 1.0
+@details client side transform and save stack. translate, scale, rotate,
+save and restore are composed locally and nothing crosses to the library
+until a unit is input. Then the net matrix and the open save levels travel
+with the unit, so units input by several threads at once each carry their own
+thread's transform rather than changing a context they share.
+*/
+
+namespace uxdevice {
+
+/**
+ * @struct save_level_t
+ * @brief one open save level of a thread. serial is taken from a count of
+ * the thread's saves, so it differs for every save even when two save blocks
+ * open at the same depth one after the other. The levels open at once form a
+ * list from the innermost to the outermost, shared by the units input under
+ * them rather than copied into each.
+ */
+struct save_level_t {
+  std::uint64_t serial = {};
+  std::size_t depth = {};
+  std::shared_ptr<const save_level_t> parent = {};
+};
+
+/**
+ * @struct unit_transform_t
+ * @brief the transform state a unit was input under. The library keeps it
+ * with the unit in its submission lane and applies it when the lanes are
+ * merged: the matrix is set before the unit is drawn, and a state unit of a
+ * lane, such as a line_width_t, applies to the later units of that lane
+ * while the save level it was input at stays open. Before each entry the
+ * consumer undoes, as restore would, the state units input at the levels
+ * deeper than shared() with the lane's previous entry.
+ */
+struct unit_transform_t {
+  matrix_t matrix = {};
+  std::size_t depth = {};
+  std::shared_ptr<const save_level_t> level = {};
+
+  /// @brief the serial of the open level at depth d, zero for the base
+  /// level and for a depth deeper than the unit's.
+  std::uint64_t serial(std::size_t d) const {
+    const save_level_t *l = level.get();
+    while (l && l->depth > d)
+      l = l->parent.get();
+    return l && l->depth == d ? l->serial : 0;
+  }
+
+  /**
+   * @fn shared
+   * @brief the depth of the deepest level open for both this unit and
+   * other, input earlier by the same thread. A level that was restored and
+   * saved again in between has a new serial, so it is not shared even
+   * though the depth is the same.
+   */
+  std::size_t shared(const unit_transform_t &other) const {
+    const save_level_t *a = level.get(), *b = other.level.get();
+    while (a && b && a->serial != b->serial) {
+      if (a->depth >= b->depth)
+        a = a->parent.get();
+      else
+        b = b->parent.get();
+    }
+    return a && b ? a->depth : 0;
+  }
+};
+
+/**
+ * @internal
+ * @class transform_stack_t
+ * @brief one thread's stack. Save levels are not issued to the library,
+ * each unit carries the levels open when it was input.
+ */
+class transform_stack_t {
+public:
+  transform_stack_t() {}
+
+  void save(void) {
+    levels.push_back(current);
+    top = std::make_shared<const save_level_t>(
+        save_level_t{++saves, levels.size(), top});
+  }
+
+  void restore(void) {
+    if (levels.empty())
+      return;
+    current = levels.back();
+    levels.pop_back();
+    top = top->parent;
+  }
+
+  void translate(double tx, double ty) { current.translate(tx, ty); }
+  void scale(double sx, double sy) { current.scale(sx, sy); }
+  void rotate(double radians) { current.rotate(radians); }
+
+  /// @brief as cairo_transform, m is applied before the current matrix.
+  void transform(const matrix_t &m) {
+    matrix_t operand = m;
+    operand.multiply(current, current);
+  }
+
+  void set(const matrix_t &m) { current._matrix = m._matrix; }
+  void identity(void) { current.init_identity(); }
+
+  const matrix_t &matrix(void) const { return current; }
+  std::size_t depth(void) const { return levels.size(); }
+
+  /// @brief the state to send with a unit input now.
+  unit_transform_t state(void) const {
+    unit_transform_t ret = {};
+    ret.matrix._matrix = current._matrix;
+    ret.depth = levels.size();
+    ret.level = top;
+    return ret;
+  }
+
+  /// @brief the thread ended its frame, the next begins from a reset
+  /// context.
+  void reset(void) {
+    levels.clear();
+    top = {};
+    current.init_identity();
+  }
+
+private:
+  matrix_t current = {};
+  std::vector<matrix_t> levels = {};
+  std::shared_ptr<const save_level_t> top = {};
+  std::uint64_t saves = {};
+};
+
+} // namespace uxdevice
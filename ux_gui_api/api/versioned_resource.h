@@ -0,0 +1,291 @@
+/*
+ * This file is part of the ux_gui_stream distribution
+ * (https://github.com/amatarazzo777/ux_gui_stream).
+ * Copyright (c) 2020 Anthony Matarazzo.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+/**
+@author Anthony Matarazzo
+@file versioned_resource.h
+@date 11/5/20
+@version 1.0
+@details shared data without a shared mutex. A shared_resource_t is locked by
+the client while it writes and by the render thread while it reads, so a long
+write stalls the frame. A versioned_resource_t is never written in place. The
+client prepares a new version and publishes it with one atomic exchange, and
+the render thread reads whichever version is current when it begins, without
+waiting. A replaced version is freed when no reader that could have seen it
+remains, as counted by epochs. One epoch and one table of reader slots serve
+every resource of the process.
+*/
+
+namespace uxdevice {
+
+/**
+ * @internal
+ * @class reader_slots_t
+ * @brief the epoch slot of each reading thread, shared by every
+ * versioned_resource_t. A thread takes a free slot on its first read and
+ * returns it when it exits, so render threads of several surfaces and their
+ * tile workers never share one. Slots are allocated in blocks of
+ * VERSIONED_RESOURCE_READERS. When every slot is held, another block is
+ * linked to the last, so any number of threads may read. Blocks are kept
+ * for the life of the process, as a slot is read without the lock.
+ */
+class reader_slots_t {
+public:
+  /// @brief the epoch announced by the calling thread while it reads, zero
+  /// otherwise.
+  static std::atomic<std::uint64_t> &local(void) {
+    thread_local const holder_t holder = {};
+    return holder.slot->epoch;
+  }
+
+  /// @brief the epoch of the process, advanced by each publish.
+  static std::atomic<std::uint64_t> &epoch(void) {
+    static std::atomic<std::uint64_t> e = 1;
+    return e;
+  }
+
+  /// @brief the oldest epoch announced by a reading thread, UINT64_MAX
+  /// when no thread is reading.
+  static std::uint64_t oldest(void) {
+    std::uint64_t ret = UINT64_MAX;
+    for (block_t *b = &head(); b; b = b->next.load())
+      for (auto &s : b->slots) {
+        std::uint64_t e = s.epoch.load();
+        if (e != 0 && e < ret)
+          ret = e;
+      }
+    return ret;
+  }
+
+  /// @brief slots held by running threads.
+  static std::size_t used(void) {
+    std::lock_guard<std::mutex> guard(lock());
+    std::size_t ret = {};
+    for (block_t *b = &head(); b; b = b->next.load())
+      for (auto &s : b->slots)
+        ret += s.taken;
+    return ret;
+  }
+
+private:
+  /// @brief one cache line per reader, so readers do not contend. taken is
+  /// guarded by lock().
+  struct alignas(64) slot_t {
+    std::atomic<std::uint64_t> epoch = {};
+    bool taken = false;
+  };
+
+  struct block_t {
+    std::array<slot_t, VERSIONED_RESOURCE_READERS> slots = {};
+    std::atomic<block_t *> next = {};
+  };
+
+  struct holder_t {
+    holder_t() : slot(acquire()) {}
+    ~holder_t() { release(slot); }
+    slot_t *slot = {};
+  };
+
+  static slot_t *acquire(void) {
+    std::lock_guard<std::mutex> guard(lock());
+    block_t *b = &head();
+    while (true) {
+      for (auto &s : b->slots)
+        if (!s.taken) {
+          s.taken = true;
+          return &s;
+        }
+      if (!b->next.load())
+        b->next.store(new block_t());
+      b = b->next.load();
+    }
+  }
+
+  static void release(slot_t *slot) {
+    std::lock_guard<std::mutex> guard(lock());
+    slot->taken = false;
+  }
+
+  static std::mutex &lock(void) {
+    static std::mutex m = {};
+    return m;
+  }
+
+  static block_t &head(void) {
+    static block_t b = {};
+    return b;
+  }
+};
+
+/**
+ * @class versioned_resource_t
+ * @tparam T the data, such as a std::string or a std::vector of points.
+ * @brief input with operator<< as a std::shared_ptr. Writers are serialized
+ * among themselves by a mutex that readers never take.
+ */
+template <typename T> class versioned_resource_t {
+  struct version_t {
+    std::unique_ptr<const T> value = {};
+    std::uint64_t number = {};
+  };
+
+public:
+  versioned_resource_t(std::unique_ptr<T> initial = std::make_unique<T>())
+      : current(new version_t{prepare(std::move(initial)), 1}) {}
+
+  ~versioned_resource_t() {
+    delete current.load();
+    for (auto &r : retired)
+      delete r.second;
+  }
+
+  versioned_resource_t(const versioned_resource_t &other) = delete;
+  versioned_resource_t &operator=(const versioned_resource_t &other) = delete;
+
+  /**
+   * @class snapshot_t
+   * @brief one version held for reading. The version is not freed while the
+   * snapshot exists, whatever is published meanwhile. A thread may nest
+   * snapshots, of this and other resources, released in reverse order. A
+   * snapshot is released on the thread that read it, as it holds that
+   * thread's slot.
+   */
+  class snapshot_t {
+  public:
+    snapshot_t(const versioned_resource_t &r) : slot(&reader_slots_t::local()) {
+      outer = slot->load(std::memory_order_relaxed) != 0;
+      if (!outer)
+        slot->store(reader_slots_t::epoch().load());
+      v = r.current.load();
+    }
+
+    ~snapshot_t() {
+      if (slot && !outer)
+        slot->store(0, std::memory_order_release);
+    }
+
+    snapshot_t(const snapshot_t &other) = delete;
+    snapshot_t &operator=(const snapshot_t &other) = delete;
+
+    snapshot_t(snapshot_t &&other) noexcept
+        : slot(other.slot), outer(other.outer), v(other.v) {
+      other.slot = {};
+    }
+
+    const T &operator*() const { return *v->value; }
+    const T *operator->() const { return v->value.get(); }
+
+    /// @brief increases with each publish, so a cached rendering of the data
+    /// can be kept while the number is unchanged.
+    std::uint64_t version(void) const { return v->number; }
+
+  private:
+    std::atomic<std::uint64_t> *slot = {};
+    bool outer = false;
+    const version_t *v = {};
+  };
+
+  /**
+   * @fn read
+   * @brief the current version. Does not block, except on the first read
+   * of a thread, which takes its slot from reader_slots_t and never fails
+   * for want of one.
+   */
+  snapshot_t read(void) const { return snapshot_t(*this); }
+
+  /**
+   * @fn publish
+   * @brief makes next the current version. Readers that began before keep
+   * the version they have.
+   */
+  void publish(std::unique_ptr<T> next) {
+    std::lock_guard<std::mutex> guard(writer);
+    publish_locked(std::move(next));
+  }
+
+  /**
+   * @fn update
+   * @brief copies the current version, applies fn(T &) to the copy and
+   * publishes it. The writer mutex is held throughout, so concurrent
+   * updates each see the result of the one before and none is lost. For
+   * large data the client may rather build the next version itself and
+   * publish() it.
+   */
+  template <typename FN> void update(FN &&fn) {
+    std::lock_guard<std::mutex> guard(writer);
+    auto next = std::make_unique<T>(*current.load()->value);
+    fn(*next);
+    publish_locked(std::move(next));
+  }
+
+  /**
+   * @fn reclaim
+   * @brief frees the replaced versions no reader holds. Called by the render
+   * thread when a frame completes. Returns immediately when a writer is
+   * publishing, which reclaims itself.
+   */
+  void reclaim(void) {
+    std::unique_lock<std::mutex> guard(writer, std::try_to_lock);
+    if (guard.owns_lock())
+      collect();
+  }
+
+  /// @brief replaced versions not yet freed.
+  std::size_t pending(void) const {
+    std::lock_guard<std::mutex> guard(writer);
+    return retired.size();
+  }
+
+private:
+  /// @brief a version is not changed once published, so a packed path is
+  /// hashed here rather than on each cache lookup.
+  static std::unique_ptr<T> prepare(std::unique_ptr<T> next) {
+    if constexpr (std::is_base_of<packed_path_storage_t, T>::value)
+      next->finalize();
+    return next;
+  }
+
+  /// @brief publish() with the writer mutex held.
+  void publish_locked(std::unique_ptr<T> next) {
+    version_t *v = new version_t{prepare(std::move(next)), {}};
+    v->number = current.load()->number + 1;
+    version_t *old = current.exchange(v);
+    retired.emplace_back(reader_slots_t::epoch().fetch_add(1), old);
+    collect();
+  }
+
+  /// @brief a version retired at epoch e may be held by a reader that
+  /// announced an epoch of e or less. Called with the writer mutex held.
+  void collect(void) {
+    std::uint64_t oldest = reader_slots_t::oldest();
+    auto it = std::remove_if(retired.begin(), retired.end(), [&](auto &r) {
+      if (r.first >= oldest)
+        return false;
+      delete r.second;
+      return true;
+    });
+    retired.erase(it, retired.end());
+  }
+
+  std::atomic<version_t *> current = {};
+  mutable std::mutex writer = {};
+  std::vector<std::pair<std::uint64_t, version_t *>> retired = {};
+};
+
+} // namespace uxdevice
@@ -0,0 +1,293 @@
+/*
+ * This file is part of the ux_gui_stream distribution
+ * (https://github.com/amatarazzo777/ux_gui_stream).
+ * Copyright (c) 2020 Anthony Matarazzo.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @author Anthony Matarazzo
+ * @file composite_test.cpp
+ * @date 11/7/20
+ * @version 1.0
+ * @brief the SSE4.1 and AVX2 blend kernels of composite.cpp against the
+ * scalar kernel, for every supported operator, and the hsl operators against
+ * the PDF blend mode formulas.
+ *
+ * - every pair of source and destination alphas, sa and da, each with the
+ *   premultiplied channel values 0, 1, alpha / 2, alpha - 1 and alpha for
+ *   s and d in every combination;
+ * - every combination of the byte corners 0, 1, 2, 127, 128, 129, 253, 254
+ *   and 255 for s, d, sa and da, including pixels that are not
+ *   premultiplied;
+ * - spans of 0, 1 and 2 whole AVX2 blocks followed by a tail of 0 to 7
+ *   pixels, with a guard pixel after the span that must not change.
+ *
+ * The hsl operators are compared with a double precision evaluation of the
+ * formulas on unpremultiplied colors, over every premultiplied pair of
+ * alpha_pairs with non zero alphas, and may differ by one.
+ *
+ * A kernel the cpu does not support is forced anyway and must run as the
+ * best supported one. Linked with composite.cpp. Exits non zero on a
+ * mismatch.
+ */
+#include <base/std_base.h>
+
+#include <api/enums.h>
+#include <api/composite.h>
+
+#include <array>
+#include <cmath>
+#include <cstdio>
+#include <iterator>
+#include <vector>
+
+using namespace uxdevice;
+
+namespace {
+
+typedef graphic_operator_options_t op_t;
+
+const op_t operators[] = {
+    op_t::op_over,       op_t::op_add,           op_t::op_multiply,
+    op_t::op_screen,     op_t::op_overlay,       op_t::op_darken,
+    op_t::op_lighten,    op_t::op_hard_light,    op_t::op_difference,
+    op_t::op_exclusion,  op_t::op_hsl_hue,       op_t::op_hsl_saturation,
+    op_t::op_hsl_color,  op_t::op_hsl_luminosity};
+
+const char *operator_names[] = {
+    "over",       "add",       "multiply", "screen",     "overlay",
+    "darken",     "lighten",   "hard_light", "difference", "exclusion",
+    "hsl_hue", "hsl_saturation", "hsl_color", "hsl_luminosity"};
+
+const std::uint32_t corners[] = {0, 1, 2, 127, 128, 129, 253, 254, 255};
+
+struct kernel_t {
+  composite_kernel_t kernel;
+  const char *name;
+  bool supported;
+};
+
+std::uint32_t pixel(std::uint32_t a, std::uint32_t r, std::uint32_t g,
+                    std::uint32_t b) {
+  return a << 24 | r << 16 | g << 8 | b;
+}
+
+/// @brief the channel values of a premultiplied pixel of alpha a that lie
+/// on the edges of the rounding.
+void channel_corners(std::uint32_t a, std::uint32_t (&c)[5]) {
+  c[0] = 0;
+  c[1] = std::min<std::uint32_t>(1, a);
+  c[2] = a / 2;
+  c[3] = a ? a - 1 : 0;
+  c[4] = a;
+}
+
+/// @brief for every sa and da, the 25 combinations of channel corners, the
+/// three color channels of a pixel each taking a different combination.
+void alpha_pairs(std::vector<std::uint32_t> &src,
+                 std::vector<std::uint32_t> &dst) {
+  std::uint32_t s[5] = {}, d[5] = {};
+  for (std::uint32_t sa = 0; sa < 256; sa++)
+    for (std::uint32_t da = 0; da < 256; da++) {
+      channel_corners(sa, s);
+      channel_corners(da, d);
+      for (std::size_t i = 0; i < 5; i++)
+        for (std::size_t j = 0; j < 5; j++) {
+          src.push_back(pixel(sa, s[i], s[j], s[(i + j) % 5]));
+          dst.push_back(pixel(da, d[j], d[i], d[(i * j) % 5]));
+        }
+    }
+}
+
+/// @brief every combination of corners for a source and a destination
+/// pixel, returned as two spans of equal length.
+void corner_pairs(std::vector<std::uint32_t> &src,
+                  std::vector<std::uint32_t> &dst) {
+  for (auto sa : corners)
+    for (auto da : corners)
+      for (auto s : corners)
+        for (auto d : corners) {
+          src.push_back(pixel(sa, s, s, s));
+          dst.push_back(pixel(da, d, d, d));
+        }
+}
+
+typedef std::array<double, 3> color_t;
+
+double lum(const color_t &c) { return 0.3 * c[0] + 0.59 * c[1] + 0.11 * c[2]; }
+
+double sat(const color_t &c) {
+  return std::max({c[0], c[1], c[2]}) - std::min({c[0], c[1], c[2]});
+}
+
+/// @brief SetLum and ClipColor of the PDF specification.
+color_t set_lum(color_t c, double l) {
+  double d = l - lum(c);
+  for (auto &v : c)
+    v += d;
+  l = lum(c);
+  double n = std::min({c[0], c[1], c[2]}), x = std::max({c[0], c[1], c[2]});
+  if (n < 0)
+    for (auto &v : c)
+      v = l + (v - l) * l / (l - n);
+  if (x > 1)
+    for (auto &v : c)
+      v = l + (v - l) * (1 - l) / (x - l);
+  return c;
+}
+
+/// @brief SetSat of the PDF specification.
+color_t set_sat(color_t c, double s) {
+  std::array<std::size_t, 3> i = {0, 1, 2};
+  std::sort(i.begin(), i.end(), [&](auto a, auto b) { return c[a] < c[b]; });
+  color_t r = {};
+  if (c[i[2]] > c[i[0]]) {
+    r[i[1]] = (c[i[1]] - c[i[0]]) * s / (c[i[2]] - c[i[0]]);
+    r[i[2]] = s;
+  }
+  return r;
+}
+
+/// @brief the premultiplied result of an hsl operator, the blend of the
+/// unpremultiplied colors weighted by sa * da.
+std::uint32_t hsl_reference(op_t op, std::uint32_t s, std::uint32_t d) {
+  double sa = (s >> 24) / 255.0, da = (d >> 24) / 255.0;
+  color_t sp = {}, dp = {}, cs = {}, cb = {};
+  for (int c = 0; c < 3; c++) {
+    sp[c] = (s >> (16 - 8 * c) & 0xff) / 255.0;
+    dp[c] = (d >> (16 - 8 * c) & 0xff) / 255.0;
+    cs[c] = sp[c] / sa;
+    cb[c] = dp[c] / da;
+  }
+
+  color_t b = {};
+  if (op == op_t::op_hsl_hue)
+    b = set_lum(set_sat(cs, sat(cb)), lum(cb));
+  else if (op == op_t::op_hsl_saturation)
+    b = set_lum(set_sat(cb, sat(cs)), lum(cb));
+  else if (op == op_t::op_hsl_color)
+    b = set_lum(cs, lum(cb));
+  else
+    b = set_lum(cb, lum(cs));
+
+  std::uint32_t out = d & 0xff000000;
+  for (int c = 0; c < 3; c++) {
+    double x = (1 - sa) * dp[c] + (1 - da) * sp[c] + sa * da * b[c];
+    out |= static_cast<std::uint32_t>(
+               std::clamp(std::lround(x * 255), 0L, 255L))
+           << (16 - 8 * c);
+  }
+  return out;
+}
+
+/// @brief pixels of the hsl operators more than one away from the formula,
+/// alpha excepted as it is the integer expression of every operator.
+std::size_t hsl_errors(op_t op, const std::vector<std::uint32_t> &src,
+                       const std::vector<std::uint32_t> &dst) {
+  std::size_t ret = {};
+  for (std::size_t i = 0; i < src.size(); i++) {
+    if (!(src[i] >> 24) || !(dst[i] >> 24))
+      continue;
+    std::uint32_t result = dst[i];
+    composite_span(op, &src[i], &result, 1, composite_kernel_t::scalar);
+    std::uint32_t expect = hsl_reference(op, src[i], dst[i]);
+    for (int shift = 0; shift < 24; shift += 8) {
+      int a = result >> shift & 0xff, b = expect >> shift & 0xff;
+      if (std::abs(a - b) > 1) {
+        ret++;
+        break;
+      }
+    }
+  }
+  return ret;
+}
+
+bool same(op_t op, const kernel_t &k, const std::uint32_t *src,
+          const std::uint32_t *dst, std::size_t n) {
+  std::vector<std::uint32_t> expect(dst, dst + n + 1), result = expect;
+  composite_span(op, src, expect.data(), n, composite_kernel_t::scalar);
+  composite_span(op, src, result.data(), n, k.kernel);
+  return expect == result;
+}
+
+} // namespace
+
+int main(void) {
+  std::vector<kernel_t> kernels = {
+      {composite_kernel_t::sse41, "sse4.1", false},
+      {composite_kernel_t::avx2, "avx2", false}};
+#if defined(__x86_64__) || defined(__i386__)
+  __builtin_cpu_init();
+  kernels[0].supported = __builtin_cpu_supports("sse4.1");
+  kernels[1].supported = __builtin_cpu_supports("avx2");
+#endif
+
+  std::vector<std::uint32_t> alpha_src = {}, alpha_dst = {};
+  alpha_pairs(alpha_src, alpha_dst);
+  std::vector<std::uint32_t> corner_src = {}, corner_dst = {};
+  corner_pairs(corner_src, corner_dst);
+
+  // a guard pixel follows each span.
+  alpha_src.push_back(0xffffffff);
+  alpha_dst.push_back(0x80402010);
+  corner_src.push_back(0xffffffff);
+  corner_dst.push_back(0x80402010);
+
+  std::size_t failures = {};
+  for (auto &k : kernels) {
+    if (!k.supported)
+      std::printf("%s: not supported by this cpu, forced\n", k.name);
+
+    for (std::size_t o = 0; o < std::size(operators); o++) {
+      op_t op = operators[o];
+      std::size_t bad = {};
+
+      bad += !same(op, k, alpha_src.data(), alpha_dst.data(),
+                   alpha_src.size() - 1);
+      bad += !same(op, k, corner_src.data(), corner_dst.data(),
+                   corner_src.size() - 1);
+
+      for (std::size_t blocks = 0; blocks <= 2; blocks++)
+        for (std::size_t tail = 0; tail < 8; tail++) {
+          std::size_t n = blocks * 8 + tail;
+          for (std::size_t at = 0; at + n < corner_src.size(); at += 97)
+            bad += !same(op, k, corner_src.data() + at,
+                         corner_dst.data() + at, n);
+        }
+
+      if (bad)
+        std::printf("%s %s: %zu mismatching spans\n", k.name,
+                    operator_names[o], bad);
+      failures += bad;
+    }
+  }
+
+  std::printf("blend kernels against scalar: %zu mismatching spans\n",
+              failures);
+
+  alpha_src.pop_back();
+  alpha_dst.pop_back();
+  for (std::size_t o = 0; o < std::size(operators); o++) {
+    op_t op = operators[o];
+    if (op != op_t::op_hsl_hue && op != op_t::op_hsl_saturation &&
+        op != op_t::op_hsl_color && op != op_t::op_hsl_luminosity)
+      continue;
+    std::size_t bad = hsl_errors(op, alpha_src, alpha_dst);
+    std::printf("%s against the formula: %zu pixels off by more than one\n",
+                operator_names[o], bad);
+    failures += bad;
+  }
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,105 @@
+/*
+ * This file is part of the ux_gui_stream distribution
+ * (https://github.com/amatarazzo777/ux_gui_stream).
+ * Copyright (c) 2020 Anthony Matarazzo.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @author Anthony Matarazzo
+ * @file damage_bench.cpp
+ * @date 11/6/20
+ * @version 1.0
+ * @brief one cell update on a 200x50 grid of text cells. Reports the units
+ * visited and the area repainted against a full repaint, and the time the
+ * damage bookkeeping and visit filter take per frame. A moved cell checks
+ * that its new area is damaged in the frame it moves. Exits non zero when a
+ * check fails.
+ */
+#include <base/std_base.h>
+
+#include <api/bounds.h>
+#include <api/damage.h>
+
+#include <chrono>
+#include <cstdio>
+
+using namespace uxdevice;
+
+namespace {
+
+constexpr std::size_t columns = 200;
+constexpr std::size_t rows = 50;
+constexpr double cell_w = 8;
+constexpr double cell_h = 16;
+
+bounds_t cell(std::size_t id) {
+  return {(id % columns) * cell_w, (id / columns) * cell_h, cell_w, cell_h};
+}
+
+/// @brief the units the render visit would render this frame.
+std::size_t visit(const damage_tracker_t &t) {
+  std::size_t ret = {};
+  for (std::size_t id = 0; id < columns * rows; id++)
+    if (t.region.intersects(cell(id)))
+      ret++;
+  return ret;
+}
+
+} // namespace
+
+int main(void) {
+  damage_tracker_t t = {};
+  bounds_t surface = {0, 0, columns * cell_w, rows * cell_h};
+  for (std::size_t id = 0; id < columns * rows; id++)
+    t.rendered(id, cell(id));
+  t.region.clear();
+
+  // one cell changed in place, its bounds measured before the visit.
+  const int frames = 1000;
+  std::size_t visited = {};
+  double area = {};
+  auto start = std::chrono::steady_clock::now();
+  for (int f = 0; f < frames; f++) {
+    std::size_t id = (static_cast<std::size_t>(f) * 7919) % (columns * rows);
+    t.changed(id);
+    for (auto n : std::vector<std::size_t>(t.units().begin(), t.units().end()))
+      t.measured(n, cell(n));
+    visited = visit(t);
+    area = t.region.area();
+    t.region.clear();
+  }
+  double ms = std::chrono::duration<double, std::milli>(
+                  std::chrono::steady_clock::now() - start)
+                  .count() /
+              frames;
+
+  std::printf("grid %zux%zu, one cell changed per frame\n", columns, rows);
+  std::printf("  units rendered %zu of %zu, area %.0f of %.0f px (%.3f%%)\n",
+              visited, columns * rows, area, surface.area(),
+              100.0 * area / surface.area());
+  std::printf("  damage and visit filter %.3f ms per frame\n", ms);
+
+  // a cell moved to an area nothing covered must be damaged there before
+  // the visit, not a frame later.
+  std::size_t moved = 5;
+  bounds_t target = {surface.w - cell_w, surface.h - cell_h, cell_w, cell_h};
+  t.changed(moved);
+  t.measured(moved, target);
+  bool ok = t.region.intersects(cell(moved)) && t.region.intersects(target);
+  std::printf("  moved cell damages old and new bounds: %s\n",
+              ok ? "yes" : "NO");
+
+  return ok && visited == 1 ? 0 : 1;
+}
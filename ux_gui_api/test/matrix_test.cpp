@@ -0,0 +1,185 @@
+/*
+ * This file is part of the ux_gui_stream distribution
+ * (https://github.com/amatarazzo777/ux_gui_stream).
+ * Copyright (c) 2020 Anthony Matarazzo.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @author Anthony Matarazzo
+ * @file matrix_test.cpp
+ * @date 11/7/20
+ * @version 1.0
+ * @brief the batch kernels of matrix.cpp against cairo. Points, distances,
+ * interleaved points and both multiply forms are compared bit for bit with
+ * cairo_matrix_transform_point, cairo_matrix_transform_distance and
+ * cairo_matrix_multiply, for random values and for signed zeros, infinities
+ * and subnormals. Every length up to 9 is run so the vector tails are
+ * covered. Linked with matrix.cpp and cairo. Exits non zero on a mismatch.
+ */
+#include <base/std_base.h>
+
+#include <api/matrix.h>
+
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <random>
+#include <vector>
+
+using namespace uxdevice;
+
+namespace {
+
+std::size_t failures = {};
+
+void check(bool ok, const char *what, std::size_t n) {
+  if (!ok) {
+    failures++;
+    std::printf("  mismatch: %s, n = %zu\n", what, n);
+  }
+}
+
+bool same(const std::vector<double> &a, const std::vector<double> &b) {
+  return std::memcmp(a.data(), b.data(), a.size() * sizeof(double)) == 0;
+}
+
+bool same(const cairo_matrix_t &a, const cairo_matrix_t &b) {
+  return std::memcmp(&a, &b, sizeof(cairo_matrix_t)) == 0;
+}
+
+void points(const cairo_matrix_t &c, const std::vector<double> &x,
+            const std::vector<double> &y) {
+  std::size_t n = x.size();
+  matrix_t m = {};
+  m._matrix = c;
+
+  std::vector<double> ex = x, ey = y, dx = x, dy = y;
+  for (std::size_t i = 0; i < n; i++) {
+    cairo_matrix_transform_point(&c, &ex[i], &ey[i]);
+    cairo_matrix_transform_distance(&c, &dx[i], &dy[i]);
+  }
+
+  std::vector<double> px = x, py = y;
+  m.transform_points(px.data(), py.data(), n);
+  check(same(px, ex) && same(py, ey), "transform_points", n);
+
+  std::vector<double> qx = x, qy = y;
+  m.transform_distances(qx.data(), qy.data(), n);
+  check(same(qx, dx) && same(qy, dy), "transform_distances", n);
+
+  std::vector<double> xy(2 * n), exy(2 * n);
+  for (std::size_t i = 0; i < n; i++) {
+    xy[2 * i] = x[i];
+    xy[2 * i + 1] = y[i];
+    exy[2 * i] = ex[i];
+    exy[2 * i + 1] = ey[i];
+  }
+  m.transform_points(xy.data(), n);
+  check(same(xy, exy), "transform_points interleaved", n);
+}
+
+void multiply(const std::vector<matrix_t> &a, const std::vector<matrix_t> &b) {
+  std::size_t n = a.size();
+  std::vector<matrix_t> r(n);
+  matrix_t::multiply(a.data(), b.data(), r.data(), n);
+  bool ok = true;
+  for (std::size_t i = 0; i < n; i++) {
+    cairo_matrix_t e = {};
+    cairo_matrix_multiply(&e, &a[i]._matrix, &b[i]._matrix);
+    ok = ok && same(r[i]._matrix, e);
+  }
+  check(ok, "multiply", n);
+
+  // result aliasing the first operand.
+  std::vector<matrix_t> in_place = a;
+  matrix_t::multiply(in_place.data(), b.data(), in_place.data(), n);
+  ok = true;
+  for (std::size_t i = 0; i < n; i++)
+    ok = ok && same(in_place[i]._matrix, r[i]._matrix);
+  check(ok, "multiply in place", n);
+
+  if (!n)
+    return;
+  const matrix_t &parent = b[0];
+  parent.multiply(a.data(), r.data(), n);
+  ok = true;
+  for (std::size_t i = 0; i < n; i++) {
+    cairo_matrix_t e = {};
+    cairo_matrix_multiply(&e, &a[i]._matrix, &parent._matrix);
+    ok = ok && same(r[i]._matrix, e);
+  }
+  check(ok, "multiply by parent", n);
+}
+
+} // namespace
+
+int main(void) {
+  std::mt19937_64 gen(20201107);
+  std::uniform_real_distribution<double> value(-1e4, 1e4);
+
+  const double inf = std::numeric_limits<double>::infinity();
+  const double tiny = std::numeric_limits<double>::denorm_min();
+  const std::vector<double> corners = {0.0, -0.0, 1.0, -1.0, 0.5, tiny,
+                                       -tiny, 1e308, -1e308, inf, -inf};
+
+  std::vector<cairo_matrix_t> matrices = {
+      {1, 0, 0, 1, 0, 0},       {1, 0, 0, 1, -0.0, -0.0},
+      {-1, 0, 0, -1, 0, 0},     {0, 1, -1, 0, 3.5, -2.25},
+      {1.3, 0.7, -0.2, 0.9, 13.1, -7.3}};
+  for (int i = 0; i < 20; i++)
+    matrices.push_back({value(gen), value(gen), value(gen), value(gen),
+                        value(gen), value(gen)});
+
+  for (auto &c : matrices) {
+    for (std::size_t n = 0; n <= 9; n++) {
+      std::vector<double> x(n), y(n);
+      for (std::size_t i = 0; i < n; i++) {
+        x[i] = value(gen);
+        y[i] = value(gen);
+      }
+      points(c, x, y);
+    }
+
+    std::vector<double> x = {}, y = {};
+    for (double a : corners)
+      for (double b : corners) {
+        x.push_back(a);
+        y.push_back(b);
+      }
+    points(c, x, y);
+  }
+
+  for (std::size_t n = 0; n <= 9; n++) {
+    std::vector<matrix_t> a(n), b(n);
+    for (std::size_t i = 0; i < n; i++) {
+      a[i]._matrix = {value(gen), value(gen), value(gen),
+                      value(gen), value(gen), value(gen)};
+      b[i]._matrix = matrices[i % matrices.size()];
+    }
+    multiply(a, b);
+  }
+
+  std::vector<matrix_t> a(1000), b(1000);
+  for (std::size_t i = 0; i < a.size(); i++) {
+    a[i]._matrix = {value(gen), value(gen), value(gen),
+                    value(gen), value(gen), value(gen)};
+    b[i]._matrix = {value(gen), value(gen), value(gen),
+                    value(gen), value(gen), value(gen)};
+  }
+  multiply(a, b);
+
+  std::printf("matrix kernels against cairo: %zu mismatches\n", failures);
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,153 @@
+/*
+ * This file is part of the ux_gui_stream distribution
+ * (https://github.com/amatarazzo777/ux_gui_stream).
+ * Copyright (c) 2020 Anthony Matarazzo.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @author Anthony Matarazzo
+ * @file mipmap_test.cpp
+ * @date 11/7/20
+ * @version 1.0
+ * @brief the SSE2 and AVX2 downscale kernels of image_mipmap.cpp against the
+ * scalar kernel.
+ *
+ * - every width from 1 to 40 and height from 1 to 5, so odd edges and every
+ *   vector tail are run, with a source stride wider than the image and a
+ *   guard pixel after each destination row that must not change;
+ * - every combination of the byte corners 0, 1, 2, 127, 128, 129, 253, 254
+ *   and 255 for the four pixels of a box;
+ * - a complete mip chain of a 1000 by 777 image.
+ *
+ * The time to build the chain of a 4096 by 4096 image is reported for each
+ * kernel. A kernel the cpu does not support is reported and skipped. Linked
+ * with image_mipmap.cpp. Exits non zero on a mismatch.
+ */
+#include <base/std_base.h>
+
+#include <api/image_mipmap.h>
+
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+using namespace uxdevice;
+
+namespace {
+
+const std::uint32_t corners[] = {0, 1, 2, 127, 128, 129, 253, 254, 255};
+
+struct kernel_t {
+  mip_kernel_t kernel;
+  const char *name;
+};
+
+std::uint32_t splat(std::uint32_t v) { return v * 0x01010101u; }
+
+/// @brief w by h of src downscaled by k and by the scalar kernel, including
+/// a guard pixel after each destination row.
+bool same(const kernel_t &k, const std::vector<std::uint32_t> &src, int w,
+          int h, int stride) {
+  int dst_w = (w + 1) / 2, dst_h = (h + 1) / 2, dst_stride = dst_w + 1;
+  std::vector<std::uint32_t> expect(
+      static_cast<std::size_t>(dst_stride) * dst_h, 0x80402010),
+      result = expect;
+  downscale_half(src.data(), w, h, stride, expect.data(), dst_stride,
+                 mip_kernel_t::scalar);
+  downscale_half(src.data(), w, h, stride, result.data(), dst_stride,
+                 k.kernel);
+  return expect == result;
+}
+
+double chain_ms(mip_kernel_t kernel, const std::vector<std::uint32_t> &src,
+                int size) {
+  int w = size, h = size;
+  std::vector<std::uint32_t> a = src, b((src.size() + 3) / 4);
+  auto start = std::chrono::steady_clock::now();
+  while (w > 1 || h > 1) {
+    downscale_half(a.data(), w, h, w, b.data(), (w + 1) / 2, kernel);
+    w = (w + 1) / 2;
+    h = (h + 1) / 2;
+    std::swap(a, b);
+  }
+  return std::chrono::duration<double, std::milli>(
+             std::chrono::steady_clock::now() - start)
+      .count();
+}
+
+} // namespace
+
+int main(void) {
+  std::vector<kernel_t> kernels = {{mip_kernel_t::sse2, "sse2"},
+                                   {mip_kernel_t::avx2, "avx2"}};
+
+  std::mt19937 gen(20201107);
+  std::vector<std::uint32_t> random(64 * 8);
+  for (auto &p : random)
+    p = gen();
+
+  // each box of the corner image is one combination, two pixels wide.
+  std::vector<std::uint32_t> row0 = {}, row1 = {};
+  for (auto a : corners)
+    for (auto b : corners)
+      for (auto c : corners)
+        for (auto d : corners) {
+          row0.push_back(splat(a));
+          row0.push_back(splat(b));
+          row1.push_back(splat(c));
+          row1.push_back(splat(d));
+        }
+  std::vector<std::uint32_t> box = row0;
+  box.insert(box.end(), row1.begin(), row1.end());
+  int box_w = static_cast<int>(row0.size());
+
+  std::vector<std::uint32_t> image(1000 * 777);
+  for (auto &p : image)
+    p = gen();
+
+  std::size_t failures = {};
+  for (auto &k : kernels) {
+    if (k.kernel > mip_kernel()) {
+      std::printf("%s: not supported by this cpu, skipped\n", k.name);
+      continue;
+    }
+
+    std::size_t bad = {};
+    for (int h = 1; h <= 5; h++)
+      for (int w = 1; w <= 40; w++)
+        bad += !same(k, random, w, h, 64);
+    bad += !same(k, box, box_w, 2, box_w);
+    bad += !same(k, image, 1000, 777, 1000);
+
+    if (bad)
+      std::printf("%s: %zu mismatching images\n", k.name, bad);
+    failures += bad;
+  }
+
+  std::vector<std::uint32_t> large(4096 * 4096);
+  for (auto &p : large)
+    p = gen();
+  std::printf("4096x4096 chain: scalar %.1f ms", chain_ms(mip_kernel_t::scalar,
+                                                          large, 4096));
+  for (auto &k : kernels)
+    if (k.kernel <= mip_kernel())
+      std::printf(", %s %.1f ms", k.name, chain_ms(k.kernel, large, 4096));
+  std::printf("\n");
+
+  std::printf("downscale kernels against scalar: %zu mismatching images\n",
+              failures);
+  return failures ? 1 : 0;
+}
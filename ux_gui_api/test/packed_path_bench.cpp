@@ -0,0 +1,162 @@
+/*
+ * This file is part of the ux_gui_stream distribution
+ * (https://github.com/amatarazzo777/ux_gui_stream).
+ * Copyright (c) 2020 Anthony Matarazzo.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @author Anthony Matarazzo
+ * @file packed_path_bench.cpp
+ * @date 11/7/20
+ * @version 1.0
+ * @brief a 100000 point polyline built and drawn as packed_path_t against
+ * one allocated unit per segment.
+ *
+ * - build: one allocation per segment, the builder functions, and polyline()
+ *   from coordinate arrays;
+ * - draw: the cache lookups of a frame, by hash_code() of a finalized path
+ *   against hashing the arrays on each lookup, and a walk of the points
+ *   against a walk of the segment units.
+ *
+ * Checks that the builder functions and polyline() store the same path,
+ * that a builder change after finalize() changes hash_code() and that
+ * finalize() picks up arrays written directly. Exits non zero when a check
+ * fails.
+ */
+#include <base/std_base.h>
+
+#include <api/packed_path.h>
+
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <vector>
+
+using namespace uxdevice;
+
+namespace {
+
+constexpr std::size_t points = 100000;
+constexpr int frames = 100;
+constexpr int lookups = 4;
+
+/// @brief stands for a line_t unit, a separate allocation per segment.
+struct segment_t {
+  virtual ~segment_t() {}
+  double x = {};
+  double y = {};
+};
+
+template <typename FN> double ms(FN &&fn) {
+  auto start = std::chrono::steady_clock::now();
+  fn();
+  return std::chrono::duration<double, std::milli>(
+             std::chrono::steady_clock::now() - start)
+      .count();
+}
+
+} // namespace
+
+int main(void) {
+  std::vector<double> xs(points), ys(points);
+  for (std::size_t i = 0; i < points; i++) {
+    xs[i] = static_cast<double>(i) * 0.5;
+    ys[i] = static_cast<double>(i % 97) * 1.25;
+  }
+
+  std::vector<std::unique_ptr<segment_t>> units = {};
+  double build_units = ms([&]() {
+    for (std::size_t i = 0; i < points; i++) {
+      auto u = std::make_unique<segment_t>();
+      u->x = xs[i];
+      u->y = ys[i];
+      units.push_back(std::move(u));
+    }
+  });
+
+  packed_path_storage_t built = {};
+  double build_builder = ms([&]() {
+    built.move_to(xs[0], ys[0]);
+    for (std::size_t i = 1; i < points; i++)
+      built.line_to(xs[i], ys[i]);
+  });
+
+  packed_path_storage_t packed = {};
+  double build_polyline =
+      ms([&]() { packed.polyline(xs.data(), ys.data(), points); });
+
+  // the library copy is finalized when it is input.
+  packed.finalize();
+
+  std::size_t sink = {};
+  double draw_finalized = ms([&]() {
+    for (int f = 0; f < frames; f++)
+      for (int l = 0; l < lookups; l++)
+        sink += packed.hash_code();
+  });
+  double draw_rehashed = ms([&]() {
+    for (int f = 0; f < frames; f++)
+      for (int l = 0; l < lookups; l++) {
+        packed.finalize();
+        sink += packed.hash_code();
+      }
+  });
+
+  double walk = {};
+  double walk_packed = ms([&]() {
+    for (int f = 0; f < frames; f++)
+      for (std::size_t i = 0; i < packed.x.size(); i++)
+        walk += packed.x[i] + packed.y[i];
+  });
+  double walk_units = ms([&]() {
+    for (int f = 0; f < frames; f++)
+      for (auto &u : units)
+        walk += u->x + u->y;
+  });
+
+  std::printf("%zu point polyline\n", points);
+  std::printf("  build: units %.2f ms, builder %.2f ms, polyline %.2f ms\n",
+              build_units, build_builder, build_polyline);
+  std::printf("  %d cache lookups per frame: finalized %.4f ms, hashed per "
+              "lookup %.3f ms\n",
+              lookups, draw_finalized / frames, draw_rehashed / frames);
+  std::printf("  walk per frame: packed %.3f ms, units %.3f ms\n",
+              walk_packed / frames, walk_units / frames);
+
+  bool same = built.verbs == packed.verbs && built.x == packed.x &&
+              built.y == packed.y && built.hash_code() == packed.hash_code();
+
+  std::size_t before = packed.hash_code();
+  packed.line_to(0, 0);
+  bool builder_rehashes = packed.hash_code() != before;
+
+  before = packed.hash_code();
+  packed.x[1] += 1;
+  packed.finalize();
+  bool finalize_rehashes = packed.hash_code() != before;
+
+  std::printf("  builder and polyline store the same path: %s\n",
+              same ? "yes" : "NO");
+  std::printf("  builder change rehashes: %s, finalize after a direct write "
+              "rehashes: %s\n",
+              builder_rehashes ? "yes" : "NO",
+              finalize_rehashes ? "yes" : "NO");
+
+  // keeps the timed loops from being removed.
+  if (sink == 1 && walk == 1)
+    std::printf("\n");
+
+  return same && builder_rehashes && finalize_rehashes ? 0 : 1;
+}
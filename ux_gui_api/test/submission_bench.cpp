@@ -0,0 +1,147 @@
+/*
+ * This file is part of the ux_gui_stream distribution
+ * (https://github.com/amatarazzo777/ux_gui_stream).
+ * Copyright (c) 2020 Anthony Matarazzo.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+/**
+ * @author Anthony Matarazzo
+ * @file submission_bench.cpp
+ * @date 11/7/20
+ * @version 1.0
+ * @brief concurrent input through submission_lanes_t with 1, 2, 4, 8 and 16
+ * producer threads, while a render thread merges the lanes as frames would.
+ * The same number of units is input at every thread count, under the block
+ * policy at the default capacity. Reports the units input per millisecond,
+ * the speed up over one producer and the times producers waited for room.
+ *
+ * Each count also checks the merge:
+ * - every unit arrives exactly once;
+ * - the units of one producer arrive in the order it input them;
+ * - the units of each merge are in z order, then sequence order, with the
+ *   producers spread over three z values.
+ *
+ * The speed up is bounded by the cores of the machine, which is printed.
+ * Exits non zero when a check fails.
+ */
+#include <base/std_base.h>
+
+#include <api/options.h>
+#include <api/enums.h>
+#include <api/matrix.h>
+#include <api/transform_stack.h>
+#include <api/submission_lanes.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+using namespace uxdevice;
+
+namespace {
+
+constexpr std::size_t units = 1 << 20;
+
+struct unit_t {
+  std::uint32_t producer = {};
+  std::uint32_t index = {};
+};
+
+typedef submission_lanes_t<unit_t> lanes_t;
+
+struct result_t {
+  double ms = {};
+  std::uint64_t waits = {};
+  bool ok = false;
+};
+
+/// @brief inputs units spread over producers, each at a z of its own, and
+/// merges until all have arrived.
+result_t run(std::size_t producers) {
+  lanes_t lanes = {};
+  std::size_t each = units / producers;
+  std::vector<std::uint32_t> next(producers);
+  std::atomic<std::size_t> done = {};
+  bool ordered = true;
+  std::size_t arrived = {};
+
+  auto start = std::chrono::steady_clock::now();
+  std::vector<std::thread> threads = {};
+  for (std::size_t p = 0; p < producers; p++)
+    threads.emplace_back([&, p]() {
+      unit_transform_t transform = {};
+      lanes.z_order(static_cast<std::int64_t>(p % 3));
+      for (std::size_t i = 0; i < each; i++)
+        lanes.push(unit_t{static_cast<std::uint32_t>(p),
+                          static_cast<std::uint32_t>(i)},
+                   false, transform);
+      done.fetch_add(1);
+    });
+
+  std::vector<lanes_t::entry_t> out = {};
+  for (;;) {
+    bool last = done.load() == producers;
+    out.clear();
+    lanes.merge(out);
+    for (std::size_t i = 0; i < out.size(); i++) {
+      auto &e = out[i];
+      if (i && (out[i - 1].z > e.z ||
+                (out[i - 1].z == e.z && out[i - 1].sequence > e.sequence)))
+        ordered = false;
+      if (e.value.index != next[e.value.producer]++)
+        ordered = false;
+    }
+    arrived += out.size();
+    if (last)
+      break;
+    std::this_thread::yield();
+  }
+  for (auto &t : threads)
+    t.join();
+
+  result_t ret = {};
+  ret.ms = std::chrono::duration<double, std::milli>(
+               std::chrono::steady_clock::now() - start)
+               .count();
+  ret.waits = lanes.statistics().waits;
+  ret.ok = ordered && arrived == each * producers;
+  for (auto n : next)
+    ret.ok = ret.ok && n == each;
+  return ret;
+}
+
+} // namespace
+
+int main(void) {
+  std::printf("%zu units, capacity %zu, %u cores\n", units,
+              static_cast<std::size_t>(SUBMISSION_QUEUE_CAPACITY),
+              std::thread::hardware_concurrency());
+
+  std::size_t failures = {};
+  double single = {};
+  for (std::size_t producers : {1, 2, 4, 8, 16}) {
+    result_t r = run(producers);
+    if (producers == 1)
+      single = r.ms;
+    std::printf("  %2zu producers: %8.0f units per ms, speed up %5.2f, "
+                "%llu waits%s\n",
+                producers, units / r.ms, single / r.ms,
+                static_cast<unsigned long long>(r.waits),
+                r.ok ? "" : ", MERGE MISMATCH");
+    failures += !r.ok;
+  }
+  return failures ? 1 : 0;
+}
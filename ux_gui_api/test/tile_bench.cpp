@@ -0,0 +1,176 @@
+/*
+ * This file is part of the ux_gui_stream distribution
+ * (https://github.com/amatarazzo777/ux_gui_stream).
+ * Copyright (c) 2020 Anthony Matarazzo.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @author Anthony Matarazzo
+ * @file tile_bench.cpp
+ * @date 11/7/20
+ * @version 1.0
+ * @brief tile parallel rendering of 5000 rectangles on a 2048 by 2048
+ * surface with 1, 2, 4, 8, 16 and 32 threads. Each tile blends its units in
+ * input order into a shared 32 bit buffer, standing in for cairo. Reports the
+ * time per frame and the speed up over one thread, and checks that every
+ * thread count produces the single thread output.
+ *
+ * Also checks the binning of tile_bins_t:
+ * - a unit drawn with an unbounded operator is in every tile;
+ * - filters whose areas do not overlap pad by the largest reach, filters
+ *   that read each other pad by the sum.
+ *
+ * The speed up is bounded by the cores of the machine, which is printed.
+ * Exits non zero when a check fails.
+ */
+#include <base/std_base.h>
+
+#include <api/options.h>
+#include <api/bounds.h>
+#include <api/enums.h>
+#include <api/tile_render.h>
+
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+using namespace uxdevice;
+
+namespace {
+
+constexpr int size = 2048;
+constexpr std::size_t rectangles = 5000;
+constexpr int frames = 3;
+
+struct unit_t {
+  bounds_t bounds = {};
+  std::uint32_t color = {};
+  bool unbounded = false;
+};
+
+/// @brief blends a channel a quarter of the way to the unit color, so the
+/// result depends on the order units are applied in.
+std::uint32_t blend(std::uint32_t d, std::uint32_t s) {
+  std::uint32_t ret = {};
+  for (int shift = 0; shift < 32; shift += 8) {
+    std::uint32_t a = d >> shift & 0xff, b = s >> shift & 0xff;
+    ret |= ((a * 3 + b) / 4) << shift;
+  }
+  return ret;
+}
+
+void render_tile(const std::vector<unit_t> &units, const tile_bins_t &bins,
+                 std::size_t tile, std::vector<std::uint32_t> &pixels) {
+  bounds_t t = bins.tiles().tile(tile);
+  for (auto i : bins.units(tile)) {
+    const unit_t &u = units[i];
+    bounds_t c = u.unbounded ? t : u.bounds.intersect(t);
+    for (int y = static_cast<int>(c.y); y < static_cast<int>(c.bottom()); y++)
+      for (int x = static_cast<int>(c.x); x < static_cast<int>(c.right());
+           x++) {
+        auto &p = pixels[static_cast<std::size_t>(y) * size + x];
+        p = u.unbounded ? p & u.color : blend(p, u.color);
+      }
+  }
+}
+
+bool bins_check(void) {
+  tile_grid_t grid(size, size);
+  tile_bins_t bins = {};
+  bins.reset(grid);
+  bins.add(0, {10, 10, 20, 20});
+  bins.add(1, {10, 10, 20, 20}, 0, graphic_operator_options_t::op_in);
+  bins.finish();
+  bool all = true;
+  for (std::size_t t = 0; t < grid.size(); t++)
+    all = all && !bins.units(t).empty() && bins.units(t).back() == 1;
+
+  bins.reset(grid);
+  bins.add(0, {0, 0, 50, 50}, 10);
+  bins.add(1, {1000, 1000, 50, 50}, 10);
+  bins.finish();
+  int apart = bins.padding();
+
+  bins.reset(grid);
+  bins.add(0, {0, 0, 50, 50}, 10);
+  bins.add(1, {55, 0, 50, 50}, 10);
+  bins.finish();
+  int through = bins.padding();
+
+  std::printf("unbounded operator in every tile: %s\n", all ? "yes" : "NO");
+  std::printf("padding of separate filters %d, of chained filters %d\n",
+              apart, through);
+  return all && apart == 10 && through == 20;
+}
+
+} // namespace
+
+int main(void) {
+  std::mt19937 gen(20201107);
+  std::uniform_real_distribution<double> pos(0, size - 8), extent(8, 120);
+  std::vector<unit_t> units(rectangles);
+  for (auto &u : units) {
+    u.bounds = {std::floor(pos(gen)), std::floor(pos(gen)),
+                std::floor(extent(gen)), std::floor(extent(gen))};
+    u.color = gen();
+  }
+  units[rectangles / 2].unbounded = true;
+  units[rectangles / 2].color = 0xfefefefe;
+
+  tile_bins_t bins = {};
+  bins.reset(tile_grid_t(size, size));
+  for (std::uint32_t i = 0; i < units.size(); i++)
+    bins.add(i, units[i].bounds, 0,
+             units[i].unbounded ? graphic_operator_options_t::op_in
+                                : graphic_operator_options_t::op_over);
+  bins.finish();
+
+  std::printf("%zu rectangles, %dx%d surface, %zu tiles, %u cores\n",
+              rectangles, size, size, bins.tiles().size(),
+              std::thread::hardware_concurrency());
+
+  std::vector<std::uint32_t> expect = {};
+  double single = {};
+  std::size_t failures = {};
+  for (std::size_t threads : {1, 2, 4, 8, 16, 32}) {
+    tile_pool_t pool(threads);
+    std::vector<std::uint32_t> pixels = {};
+    auto start = std::chrono::steady_clock::now();
+    for (int f = 0; f < frames; f++) {
+      pixels.assign(static_cast<std::size_t>(size) * size, 0xff000000);
+      pool.run(bins.tiles().size(), [&](std::size_t tile, std::size_t) {
+        render_tile(units, bins, tile, pixels);
+      });
+    }
+    double ms = std::chrono::duration<double, std::milli>(
+                    std::chrono::steady_clock::now() - start)
+                    .count() /
+                frames;
+
+    if (threads == 1) {
+      expect = pixels;
+      single = ms;
+    }
+    bool same = pixels == expect;
+    failures += !same;
+    std::printf("  %2zu threads: %7.2f ms per frame, speed up %5.2f%s\n",
+                threads, ms, single / ms, same ? "" : ", OUTPUT DIFFERS");
+  }
+
+  if (!bins_check())
+    failures++;
+  return failures ? 1 : 0;
+}
@@ -35,15 +35,43 @@
 // clang-format off
 #include <api/options.h>
 #include <api/client_interface.h>
+#include <api/bounds.h>
+#include <api/coalesce.h>
+#include <api/damage.h>
 #include <api/enums.h>
+#include <api/composite.h>
 #include <api/indirect_index.h>
 #include <api/interface_guid.h>
+#include <api/frame_statistics.h>
 #include <api/key_storage.h>
-#include <api/library_linkage.h>
+#include <api/text_edit.h>
 #include <api/listeners.h>
+#include <api/interaction.h>
+#include <api/lru_cache.h>
+#include <api/mapped_file.h>
+#include <api/thread_pool.h>
+#include <api/packed_path.h>
+#include <api/versioned_resource.h>
 #include <api/matrix.h>
+#include <api/transform_stack.h>
+#include <api/library_linkage.h>
+#include <api/layer_cache.h>
+#include <api/painter_brush.h>
+#include <api/path_simplify.h>
+#include <api/raster_cache.h>
+#include <api/resize.h>
+#include <api/scroll.h>
+#include <api/stroke_cache.h>
+#include <api/submission_lanes.h>
+#include <api/text_index.h>
+#include <api/text_source.h>
+#include <api/tile_render.h>
+#include <api/image_loader.h>
+#include <api/image_mipmap.h>
+#include <api/instance_list.h>
 #include <api/typed_index.h>
 
 #include <api_declaration.h>
+#include <api/culling.h>
 
 // clang-format on